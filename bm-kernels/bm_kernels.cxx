@@ -0,0 +1,718 @@
+#include <ROOT/RNTupleDescriptor.hxx>
+#include <ROOT/RNTupleInspector.hxx>
+
+#include <Compression.h>
+#include <RZip.h>
+#include <TFile.h>
+#include <TKey.h>
+#include <TLeaf.h>
+#include <TROOT.h>
+#include <TTree.h>
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bm-utils/bm_ntuple_compat.hxx"
+#include "bm-utils/bm_options.hxx"
+#include "bm-utils/bm_output.hxx"
+
+using ROOT::Experimental::ClusterSize_t;
+using ROOT::Experimental::DescriptorId_t;
+using ROOT::Experimental::EColumnType;
+using ROOT::Experimental::RClusterIndex;
+using ROOT::Experimental::RNTupleInspector;
+
+// Microbenchmarks of the kernels that turn the bytes on storage into values in memory, run in
+// isolation on the pages (RNTuple) or baskets (TTree) of a benchmark file:
+//   unzip   -- decompression of the ROOT compression blocks of a page or basket, with the
+//              algorithm the file was written with or, with -c, after recompressing the pages in
+//              memory with other compression settings
+//   unpack  -- decoding of the packed RNTuple column elements into their in-memory type, e.g.
+//              byte-splitting of floats, delta encoding of offsets and zigzag encoding of signed
+//              integers
+// The pages are grouped by their column type (or TTree leaf type) and loaded into memory up front,
+// so no I/O is part of the measurement. With multiple threads, the pages of a group are processed
+// by all threads in parallel.
+
+// ROOT compresses buffers in blocks of at most this size, each with its own header.
+constexpr int kMaxZipBlockSize = 0xffffff;
+constexpr int kZipHeaderSize = 9;
+
+struct KernelConfig {
+  std::string inputPath;
+  std::string storeName = "CollectionTree";
+  bool isRNTuple = false;
+  std::regex columnRegex{".*"};
+  std::vector<int> compressionSettings; // to recompress the pages with, if any
+  int fileCompression = 0;
+  std::vector<unsigned> threadCounts = {1};
+  unsigned nRepetitions = 5;
+  std::size_t maxGroupBytes = 256 * 1000 * 1000; // uncompressed bytes loaded per group
+  EOutputFormat outputFormat = EOutputFormat::kText;
+};
+
+struct Page {
+  std::vector<unsigned char> sealed; // as on storage, without the TKey header for baskets
+  std::vector<unsigned char> packed; // after decompression
+  std::size_t nElements = 0;
+  bool isCompressed() const { return sealed.size() != packed.size(); }
+};
+
+// The pages of all columns of the same type.
+struct PageGroup {
+  std::string typeName;
+  EColumnType columnType = EColumnType::kUnknown; // RNTuple only
+  std::vector<Page> pages;
+  std::size_t packedBytes = 0;
+};
+
+struct KernelResult {
+  std::string kernel;
+  std::string typeName;
+  std::string algorithm;
+  int compression;
+  bool isRecompressed;
+  unsigned nThreads;
+  std::size_t nPages;
+  std::size_t nStoredPages; // pages that are stored uncompressed and hence not unzipped
+  std::uint64_t inputBytes;
+  std::uint64_t outputBytes;
+  double time; // in seconds, median over the repetitions
+};
+
+// Compression
+
+std::string getAlgorithmName(const std::vector<Page> &pages) {
+  for (const auto &page : pages) {
+    if (!page.isCompressed())
+      continue;
+    const std::string magic(page.sealed.begin(), page.sealed.begin() + 2);
+    if (magic == "ZL")
+      return "zlib";
+    if (magic == "XZ")
+      return "lzma";
+    if (magic == "L4")
+      return "lz4";
+    if (magic == "ZS")
+      return "zstd";
+    if (magic == "CS")
+      return "old";
+    return magic;
+  }
+  return "none";
+}
+
+// Decompresses all blocks of a buffer, returning false if the buffer is corrupt.
+bool unzipBuffer(const unsigned char *source, std::size_t sourceSize, unsigned char *target,
+                 std::size_t targetSize) {
+  std::size_t sourcePos = 0;
+  std::size_t targetPos = 0;
+  while (sourcePos < sourceSize) {
+    auto block = const_cast<unsigned char *>(source + sourcePos);
+    int blockSize = 0;
+    int blockTargetSize = 0;
+    if (R__unzip_header(&blockSize, block, &blockTargetSize) != 0)
+      return false;
+
+    int availableSize = sourceSize - sourcePos;
+    int availableTargetSize = targetSize - targetPos;
+    int unzippedSize = 0;
+    R__unzip(&availableSize, block, &availableTargetSize, target + targetPos, &unzippedSize);
+    if (unzippedSize != blockTargetSize)
+      return false;
+
+    sourcePos += blockSize;
+    targetPos += unzippedSize;
+  }
+  return targetPos == targetSize;
+}
+
+// Compresses a buffer in blocks like ROOT does, falling back to storing it uncompressed if
+// compression does not reduce its size.
+std::vector<unsigned char> zipBuffer(const std::vector<unsigned char> &source, int compression) {
+  const auto algorithm =
+      static_cast<ROOT::RCompressionSetting::EAlgorithm::EValues>(compression / 100);
+  const int level = compression % 100;
+  if (level == 0)
+    return source;
+
+  std::vector<unsigned char> target(source.size());
+  std::size_t sourcePos = 0;
+  std::size_t targetPos = 0;
+  while (sourcePos < source.size()) {
+    int blockSize = std::min<std::size_t>(kMaxZipBlockSize, source.size() - sourcePos);
+    int availableTargetSize = target.size() - targetPos;
+    int zippedSize = 0;
+    if (availableTargetSize > kZipHeaderSize) {
+      auto block = const_cast<char *>(reinterpret_cast<const char *>(source.data())) + sourcePos;
+      auto targetBlock = reinterpret_cast<char *>(target.data()) + targetPos;
+      R__zipMultipleAlgorithm(level, &blockSize, block, &availableTargetSize, targetBlock,
+                              &zippedSize, algorithm);
+    }
+    if (zippedSize == 0)
+      return source;
+
+    sourcePos += blockSize;
+    targetPos += zippedSize;
+  }
+  target.resize(targetPos);
+  return target;
+}
+
+// Page extraction
+
+std::unique_ptr<RColumnElementBase> createElement(EColumnType type) {
+  switch (type) {
+  case EColumnType::kIndex64:
+  case EColumnType::kIndex32:
+  case EColumnType::kSplitIndex64:
+  case EColumnType::kSplitIndex32:
+    return RColumnElementBase::Generate<ClusterSize_t>(type);
+  case EColumnType::kReal64:
+  case EColumnType::kSplitReal64:
+    return RColumnElementBase::Generate<double>(type);
+  case EColumnType::kReal32:
+  case EColumnType::kSplitReal32:
+    return RColumnElementBase::Generate<float>(type);
+  case EColumnType::kInt64:
+  case EColumnType::kSplitInt64:
+    return RColumnElementBase::Generate<std::int64_t>(type);
+  case EColumnType::kUInt64:
+  case EColumnType::kSplitUInt64:
+    return RColumnElementBase::Generate<std::uint64_t>(type);
+  case EColumnType::kInt32:
+  case EColumnType::kSplitInt32:
+    return RColumnElementBase::Generate<std::int32_t>(type);
+  case EColumnType::kUInt32:
+  case EColumnType::kSplitUInt32:
+    return RColumnElementBase::Generate<std::uint32_t>(type);
+  case EColumnType::kInt16:
+  case EColumnType::kSplitInt16:
+    return RColumnElementBase::Generate<std::int16_t>(type);
+  case EColumnType::kUInt16:
+  case EColumnType::kSplitUInt16:
+    return RColumnElementBase::Generate<std::uint16_t>(type);
+  case EColumnType::kInt8:
+    return RColumnElementBase::Generate<std::int8_t>(type);
+  case EColumnType::kUInt8:
+    return RColumnElementBase::Generate<std::uint8_t>(type);
+  case EColumnType::kChar:
+    return RColumnElementBase::Generate<char>(type);
+  case EColumnType::kBit:
+    return RColumnElementBase::Generate<bool>(type);
+  default:
+    return nullptr;
+  }
+}
+
+std::string getTopLevelFieldName(const ROOT::Experimental::RNTupleDescriptor &descriptor,
+                                 DescriptorId_t fieldId) {
+  while (descriptor.GetFieldDescriptor(fieldId).GetParentId() != descriptor.GetFieldZeroId()) {
+    fieldId = descriptor.GetFieldDescriptor(fieldId).GetParentId();
+  }
+  return descriptor.GetFieldDescriptor(fieldId).GetFieldName();
+}
+
+// Adds a page to its group, unless the group is full.
+void addPage(PageGroup &group, Page &&page, const KernelConfig &config) {
+  if (group.packedBytes + page.packed.size() > config.maxGroupBytes)
+    return;
+  group.packedBytes += page.packed.size();
+  group.pages.emplace_back(std::move(page));
+}
+
+// Returns the groups with at least one page. A group stays empty if all of its pages are larger
+// than the group limit (or could not be decompressed), and there is nothing to time for it.
+template <typename K> std::vector<PageGroup> getLoadedGroups(std::map<K, PageGroup> &groups) {
+  std::vector<PageGroup> result;
+  for (auto &[_, group] : groups) {
+    if (group.pages.empty()) {
+      std::cerr << "WARNING: no pages of type " << group.typeName
+                << " loaded, since they are larger than the group limit (-l)" << std::endl;
+      continue;
+    }
+    result.emplace_back(std::move(group));
+  }
+  return result;
+}
+
+// Pages that cannot be decompressed are skipped and counted in nUnzipErrors.
+std::vector<PageGroup> loadNTuplePages(const KernelConfig &config, std::size_t &nUnzipErrors) {
+  auto pageSource = RPageSource::Create(config.storeName, config.inputPath);
+  pageSource->Attach();
+
+  struct PageLocation {
+    DescriptorId_t physicalColumnId;
+    EColumnType columnType;
+    RClusterIndex clusterIndex;
+    std::size_t nElements;
+  };
+  std::vector<PageLocation> locations;
+
+  {
+    auto descriptor = pageSource->GetSharedDescriptorGuard();
+    for (const auto &cluster : descriptor->GetClusterIterable()) {
+      for (const auto &column : descriptor->GetColumnIterable()) {
+        const auto physicalId = column.GetPhysicalId();
+        if (physicalId != column.GetLogicalId() || !cluster.ContainsColumn(physicalId))
+          continue;
+        if (!std::regex_match(getTopLevelFieldName(*descriptor, column.GetFieldId()),
+                              config.columnRegex)) {
+          continue;
+        }
+
+        std::size_t firstElement = 0;
+        for (const auto &pageInfo : cluster.GetPageRange(physicalId).fPageInfos) {
+          locations.emplace_back(PageLocation{physicalId, column.GetModel().GetType(),
+                                              RClusterIndex(cluster.GetId(), firstElement),
+                                              pageInfo.fNElements});
+          firstElement += pageInfo.fNElements;
+        }
+      }
+    }
+  }
+
+  std::map<EColumnType, PageGroup> groups;
+  for (const auto &location : locations) {
+    auto element = createElement(location.columnType);
+    if (!element)
+      continue;
+
+    auto &group = groups[location.columnType];
+    group.typeName = RColumnElementBase::GetTypeName(location.columnType);
+    group.columnType = location.columnType;
+
+    RPageStorage::RSealedPage sealedPage;
+    pageSource->LoadSealedPage(location.physicalColumnId, location.clusterIndex, sealedPage);
+    Page page;
+    page.sealed.resize(sealedPage.fSize);
+    sealedPage.fBuffer = page.sealed.data();
+    pageSource->LoadSealedPage(location.physicalColumnId, location.clusterIndex, sealedPage);
+
+    page.nElements = location.nElements;
+    page.packed.resize(element->GetPackedSize(page.nElements));
+    if (!page.isCompressed()) {
+      page.packed = page.sealed;
+    } else if (!unzipBuffer(page.sealed.data(), page.sealed.size(), page.packed.data(),
+                            page.packed.size())) {
+      std::cerr << "WARNING: could not decompress page of column " << location.physicalColumnId
+                << std::endl;
+      nUnzipErrors++;
+      continue;
+    }
+    addPage(group, std::move(page), config);
+  }
+
+  return getLoadedGroups(groups);
+}
+
+// Baskets are read from the file as is. They start with the header of their TKey, which contains
+// the uncompressed size of the basket and the size of the header itself. The header is parsed by
+// TKey, since its layout depends on the key version (large files use 64-bit seek offsets).
+std::vector<PageGroup> loadTreeBaskets(const KernelConfig &config, std::size_t &nUnzipErrors) {
+  auto file = std::unique_ptr<TFile>(TFile::Open(config.inputPath.c_str()));
+  auto tree = file->Get<TTree>(config.storeName.c_str());
+
+  std::map<std::string, PageGroup> groups;
+  for (auto leaf : TRangeDynCast<TLeaf>(tree->GetListOfLeaves())) {
+    if (!leaf)
+      continue;
+    auto branch = leaf->GetBranch();
+    if (branch->GetListOfLeaves()->At(0) != leaf ||
+        !std::regex_match(branch->GetName(), config.columnRegex)) {
+      continue;
+    }
+
+    auto &group = groups[leaf->GetTypeName()];
+    group.typeName = leaf->GetTypeName();
+
+    for (Int_t b = 0; b < branch->GetWriteBasket(); ++b) {
+      const auto nBytes = branch->GetBasketBytes()[b];
+      std::vector<unsigned char> buffer(nBytes);
+      if (file->ReadBuffer(reinterpret_cast<char *>(buffer.data()), branch->GetBasketSeek(b),
+                           nBytes)) {
+        std::cerr << "WARNING: could not read basket " << b << " of " << branch->GetName()
+                  << std::endl;
+        continue;
+      }
+
+      TKey key(file.get());
+      auto keyBuffer = reinterpret_cast<char *>(buffer.data());
+      key.ReadKeyBuffer(keyBuffer);
+      if (key.GetKeylen() <= 0 || key.GetKeylen() > nBytes) {
+        std::cerr << "WARNING: invalid key header of basket " << b << " of " << branch->GetName()
+                  << std::endl;
+        nUnzipErrors++;
+        continue;
+      }
+
+      Page page;
+      page.sealed.assign(buffer.begin() + key.GetKeylen(), buffer.end());
+      page.packed.resize(key.GetObjlen());
+      if (!page.isCompressed()) {
+        page.packed = page.sealed;
+      } else if (!unzipBuffer(page.sealed.data(), page.sealed.size(), page.packed.data(),
+                              page.packed.size())) {
+        std::cerr << "WARNING: could not decompress basket " << b << " of " << branch->GetName()
+                  << std::endl;
+        nUnzipErrors++;
+        continue;
+      }
+      addPage(group, std::move(page), config);
+    }
+  }
+
+  return getLoadedGroups(groups);
+}
+
+// Kernels
+
+double getSecondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Runs kernel(page, buffer) for all pages, distributed round-robin over the threads, and returns
+// the median wall time over the repetitions. Every thread has its own output buffer. The threads
+// are started once, before the first repetition, and wait for the start of each repetition, so
+// starting them is not part of the measurement.
+template <typename F>
+double timeKernel(const std::vector<Page> &pages, std::size_t bufferSize, unsigned nThreads,
+                  unsigned nRepetitions, F &&kernel) {
+  std::vector<std::vector<unsigned char>> buffers(nThreads,
+                                                  std::vector<unsigned char>(bufferSize));
+
+  std::vector<double> times;
+  if (nThreads == 1) {
+    for (unsigned r = 0; r < nRepetitions; ++r) {
+      const auto start = std::chrono::steady_clock::now();
+      for (const auto &page : pages)
+        kernel(page, buffers[0].data());
+      times.emplace_back(getSecondsSince(start));
+    }
+  } else {
+    std::mutex mutex;
+    std::condition_variable startCondition, doneCondition;
+    unsigned nStarted = 0; // number of repetitions started so far
+    unsigned nDone = 0;    // number of threads done with the current repetition
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < nThreads; ++t) {
+      threads.emplace_back([&, t]() {
+        for (unsigned r = 1; r <= nRepetitions; ++r) {
+          {
+            std::unique_lock<std::mutex> lock(mutex);
+            startCondition.wait(lock, [&]() { return nStarted >= r; });
+          }
+          for (std::size_t i = t; i < pages.size(); i += nThreads)
+            kernel(pages[i], buffers[t].data());
+          {
+            std::lock_guard<std::mutex> lock(mutex);
+            nDone++;
+          }
+          doneCondition.notify_one();
+        }
+      });
+    }
+
+    for (unsigned r = 1; r <= nRepetitions; ++r) {
+      std::unique_lock<std::mutex> lock(mutex);
+      nDone = 0;
+      nStarted = r;
+      const auto start = std::chrono::steady_clock::now();
+      lock.unlock();
+      startCondition.notify_all();
+      lock.lock();
+      doneCondition.wait(lock, [&]() { return nDone == nThreads; });
+      times.emplace_back(getSecondsSince(start));
+    }
+
+    for (auto &thread : threads) {
+      thread.join();
+    }
+  }
+
+  std::sort(times.begin(), times.end());
+  const auto n = times.size();
+  return n % 2 ? times[n / 2] : (times[n / 2 - 1] + times[n / 2]) / 2.;
+}
+
+KernelResult runUnzip(const KernelConfig &config, const PageGroup &group,
+                      const std::vector<Page> &pages, int compression, bool isRecompressed,
+                      unsigned nThreads) {
+  KernelResult result{"unzip", group.typeName, getAlgorithmName(pages), compression,
+                      isRecompressed, nThreads, pages.size(), 0, 0, 0, 0.};
+
+  std::size_t maxPackedSize = 0;
+  for (const auto &page : pages) {
+    if (!page.isCompressed()) {
+      result.nStoredPages++;
+      continue;
+    }
+    result.inputBytes += page.sealed.size();
+    result.outputBytes += page.packed.size();
+    maxPackedSize = std::max(maxPackedSize, page.packed.size());
+  }
+
+  result.time = timeKernel(pages, maxPackedSize, nThreads, config.nRepetitions,
+                           [](const Page &page, unsigned char *buffer) {
+                             if (page.isCompressed())
+                               unzipBuffer(page.sealed.data(), page.sealed.size(), buffer,
+                                           page.packed.size());
+                           });
+  return result;
+}
+
+KernelResult runUnpack(const KernelConfig &config, const PageGroup &group, unsigned nThreads) {
+  KernelResult result{"unpack", group.typeName, "", config.fileCompression, false, nThreads,
+                      group.pages.size(), 0, 0, 0, 0.};
+
+  auto element = createElement(group.columnType);
+  std::size_t maxUnpackedSize = 0;
+  for (const auto &page : group.pages) {
+    result.inputBytes += page.packed.size();
+    result.outputBytes += page.nElements * element->GetSize();
+    maxUnpackedSize = std::max(maxUnpackedSize, page.nElements * element->GetSize());
+  }
+
+  result.time = timeKernel(group.pages, maxUnpackedSize, nThreads, config.nRepetitions,
+                           [&](const Page &page, unsigned char *buffer) {
+                             auto packed = const_cast<unsigned char *>(page.packed.data());
+                             element->Unpack(buffer, packed, page.nElements);
+                           });
+  return result;
+}
+
+std::vector<KernelResult> runKernels(const KernelConfig &config, std::vector<PageGroup> &groups) {
+  std::vector<KernelResult> results;
+
+  for (auto &group : groups) {
+    if (config.compressionSettings.empty()) {
+      for (const auto nThreads : config.threadCounts)
+        results.emplace_back(
+            runUnzip(config, group, group.pages, config.fileCompression, false, nThreads));
+    } else {
+      for (const auto compression : config.compressionSettings) {
+        std::vector<Page> pages;
+        for (const auto &page : group.pages) {
+          Page recompressed;
+          recompressed.sealed = zipBuffer(page.packed, compression);
+          recompressed.packed = page.packed;
+          recompressed.nElements = page.nElements;
+          pages.emplace_back(std::move(recompressed));
+        }
+        for (const auto nThreads : config.threadCounts)
+          results.emplace_back(runUnzip(config, group, pages, compression, true, nThreads));
+      }
+    }
+
+    if (config.isRNTuple) {
+      for (const auto nThreads : config.threadCounts)
+        results.emplace_back(runUnpack(config, group, nThreads));
+    }
+  }
+
+  return results;
+}
+
+// Output
+
+void printResults(const std::vector<KernelResult> &results) {
+  std::cout << "kernel\ttype\talgorithm\tcompression\trecompressed\tthreads\tpages\t"
+               "stored_pages\tinput_MB\toutput_MB\ttime_s\tGB/s"
+            << std::endl;
+  for (const auto &r : results) {
+    std::cout << r.kernel << "\t" << r.typeName << "\t" << r.algorithm << "\t" << r.compression
+              << "\t" << r.isRecompressed << "\t" << r.nThreads << "\t" << r.nPages << "\t"
+              << r.nStoredPages << "\t" << r.inputBytes / 1e6 << "\t" << r.outputBytes / 1e6 << "\t"
+              << r.time << "\t" << (r.time > 0 ? r.outputBytes / 1e9 / r.time : 0.) << std::endl;
+  }
+}
+
+std::vector<MetricsRecord_t> getRecords(const KernelConfig &config,
+                                        const std::vector<KernelResult> &results) {
+  std::vector<MetricsRecord_t> records;
+  for (const auto &r : results) {
+    MetricsRecord_t record;
+    addMetric(record, "file", config.inputPath);
+    addMetric(record, "format", config.isRNTuple ? "rntuple" : "ttree");
+    addMetric(record, "kernel", r.kernel);
+    addMetric(record, "type", r.typeName);
+    addMetric(record, "algorithm", r.algorithm);
+    addMetric(record, "compression", r.compression);
+    addMetric(record, "recompressed", r.isRecompressed);
+    addMetric(record, "threads", r.nThreads);
+    addMetric(record, "pages", r.nPages);
+    addMetric(record, "stored_pages", r.nStoredPages);
+    addMetric(record, "input_bytes", r.inputBytes);
+    addMetric(record, "output_bytes", r.outputBytes);
+    addMetric(record, "time_s", r.time);
+    addMetric(record, "gb_per_s", r.time > 0 ? r.outputBytes / 1e9 / r.time : 0.);
+    records.emplace_back(std::move(record));
+  }
+  return records;
+}
+
+static void printUsage(std::string_view prog) {
+  std::cout << "USAGE: " << prog
+            << " (-h|-i INPUT_PATH -s (ttree|rntuple) [-n STORE_NAME] [-x COLUMN_REGEX] "
+               "[-c COMPRESSION[,COMPRESSION...]] [-t N_THREADS[,N_THREADS...]] "
+               "[-r N_REPETITIONS] [-l MAX_MB_PER_TYPE] [-o (text|json|csv)])"
+            << std::endl;
+}
+
+// Parses a comma-separated list of non-negative values, each of which is checked with isValid.
+template <typename T, typename F>
+bool parseList(const char *arg, std::vector<T> &values, F &&isValid) {
+  values.clear();
+  std::istringstream ss(arg);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    unsigned value;
+    if (!parseUnsigned(item.c_str(), value) || !isValid(value))
+      return false;
+    values.emplace_back(value);
+  }
+  return !values.empty();
+}
+
+int main(int argc, char **argv) {
+  // Suppress (irrelevant) warnings
+  gErrorIgnoreLevel = kError;
+
+  KernelConfig config;
+  bool hasStorageType = false;
+
+  int c;
+  while ((c = getopt(argc, argv, "hi:s:n:x:c:t:r:l:o:")) != -1) {
+    switch (c) {
+    case 'h':
+      printUsage(argv[0]);
+      return 0;
+    case 'i':
+      config.inputPath = optarg;
+      break;
+    case 's':
+      if (strcmp(optarg, "rntuple") == 0) {
+        config.isRNTuple = true;
+      } else if (strcmp(optarg, "ttree") != 0) {
+        std::cerr << "ERROR: Unknown storage mode " << optarg << std::endl;
+        return 1;
+      }
+      hasStorageType = true;
+      break;
+    case 'n':
+      config.storeName = optarg;
+      break;
+    case 'x':
+      config.columnRegex = std::regex(optarg);
+      break;
+    case 'c':
+      if (!parseList(optarg, config.compressionSettings, isValidCompression)) {
+        std::cerr << "ERROR: invalid compression settings " << optarg << std::endl;
+        return 1;
+      }
+      break;
+    case 't':
+      if (!parseList(optarg, config.threadCounts, [](unsigned n) { return n > 0; })) {
+        std::cerr << "ERROR: invalid thread counts " << optarg << std::endl;
+        return 1;
+      }
+      break;
+    case 'r':
+      if (!parseUnsigned(optarg, config.nRepetitions)) {
+        std::cerr << "ERROR: invalid number of repetitions " << optarg << std::endl;
+        return 1;
+      }
+      if (config.nRepetitions < 1) {
+        std::cerr << "ERROR: the number of repetitions must be at least 1" << std::endl;
+        return 1;
+      }
+      break;
+    case 'l':
+      if (std::atof(optarg) <= 0.) {
+        std::cerr << "ERROR: the maximum MB per type must be positive" << std::endl;
+        return 1;
+      }
+      config.maxGroupBytes = std::atof(optarg) * 1e6;
+      break;
+    case 'o':
+      if (!parseOutputFormat(optarg, config.outputFormat)) {
+        std::cerr << "ERROR: Unknown output format " << optarg << std::endl;
+        return 1;
+      }
+      break;
+    default:
+      printUsage(argv[0]);
+      return 1;
+    }
+  }
+
+  if (config.inputPath.empty()) {
+    std::cerr << "ERROR: please provide an input path\n" << std::endl;
+    printUsage(argv[0]);
+    return 1;
+  }
+
+  if (!hasStorageType) {
+    std::cerr << "ERROR: please specify the storage type (ttree or rntuple)\n" << std::endl;
+    printUsage(argv[0]);
+    return 1;
+  }
+
+  if (config.isRNTuple) {
+    config.fileCompression =
+        RNTupleInspector::Create(config.storeName, config.inputPath)->GetCompressionSettings();
+  } else {
+    auto file = std::unique_ptr<TFile>(TFile::Open(config.inputPath.c_str()));
+    config.fileCompression = file->GetCompressionSettings();
+  }
+
+  std::size_t nUnzipErrors = 0;
+  auto groups = config.isRNTuple ? loadNTuplePages(config, nUnzipErrors)
+                                 : loadTreeBaskets(config, nUnzipErrors);
+  // Every page must be decompressed correctly when loading it, otherwise the kernels would be
+  // timed on a different set of pages than the one in the file.
+  if (nUnzipErrors > 0) {
+    std::cerr << "ERROR: could not decompress " << nUnzipErrors << " pages" << std::endl;
+    return 1;
+  }
+  if (groups.empty()) {
+    std::cerr << "ERROR: no pages found for the selected columns" << std::endl;
+    return 1;
+  }
+
+  // Smoke check that the pages of a compressed file have been decompressed, rather than all being
+  // taken as stored uncompressed.
+  const bool hasCompressedPages =
+      std::any_of(groups.begin(), groups.end(), [](const PageGroup &group) {
+        return std::any_of(group.pages.begin(), group.pages.end(),
+                           [](const Page &page) { return page.isCompressed(); });
+      });
+  if (config.fileCompression % 100 != 0 && !hasCompressedPages) {
+    std::cerr << "ERROR: none of the pages of the compressed input could be decompressed"
+              << std::endl;
+    return 1;
+  }
+
+  const auto results = runKernels(config, groups);
+
+  if (config.outputFormat == EOutputFormat::kText)
+    printResults(results);
+  else
+    writeRecords(std::cout, getRecords(config, results), config.outputFormat);
+
+  return 0;
+}
@@ -2,34 +2,66 @@
 #include <ROOT/RDataFrame.hxx>
 #include <ROOT/RNTuple.hxx>
 #include <ROOT/RNTupleDS.hxx>
+#include <ROOT/RNTupleInspector.hxx>
+#include <ROOT/RNTupleMetrics.hxx>
 #include <ROOT/RNTupleModel.hxx>
 #include <ROOT/RNTupleView.hxx>
 #include <ROOT/RVec.hxx>
 
 #include <TApplication.h>
+#include <TBasket.h>
 #include <TBranch.h>
 #include <TCanvas.h>
+#include <TChain.h>
 #include <TFile.h>
 #include <TH1F.h>
+#include <TLeaf.h>
+#include <TROOT.h>
 #include <TRootCanvas.h>
 #include <TSystem.h>
 #include <TTree.h>
+#include <TTreeCache.h>
+#include <TTreeCacheUnzip.h>
 #include <TTreePerfStats.h>
+#include <TTreeReader.h>
+#include <TTreeReaderArray.h>
+
+#include <fcntl.h>
+#include <glob.h>
+#include <unistd.h>
 
 #include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
 #include <future>
 #include <iostream>
 #include <iterator>
+#include <memory>
+#include <numeric>
+#include <optional>
 #include <random>
+#include <regex>
+#include <set>
+#include <sstream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
+#include "bm-utils/bm_memory.hxx"
+#include "bm-utils/bm_ntuple_compat.hxx"
+#include "bm-utils/bm_output.hxx"
+
 using ROOT::RDataFrame;
 using ROOT::Experimental::RNTuple;
+using ROOT::Experimental::RNTupleInspector;
 using ROOT::Experimental::RNTupleModel;
 using ROOT::Experimental::RNTupleReader;
+using ROOT::Experimental::RNTupleReadOptions;
 using ROOT::Experimental::RNTupleView;
+using ROOT::Experimental::RNTupleViewCollection;
+using ROOT::Experimental::Detail::RNTupleMetrics;
 
 static void showHist(TH1D *hist) {
   auto app = TApplication("", nullptr, nullptr);
@@ -47,7 +79,20 @@ static void showHist(TH1D *hist) {
   return;
 }
 
-void bmRDFReadspeed(ROOT::RDataFrame &rdf, bool isRNTuple) {
+// Description of which columns are read in the event loop. Column patterns are regular expressions
+// which are matched against the full column names as exposed by RDataFrame. Since RNTuple field
+// names have their dots converted to underscores, a '.' in a pattern conveniently matches both.
+struct Workload {
+  std::vector<std::string> columnPatterns;
+  // Fraction of the matching columns to read. The columns are picked pseudo-randomly with a fixed
+  // seed, so the same selection is made for every run.
+  double fraction = 1.;
+  // Optional filter expression. All columns that are not used in the filter itself are only read
+  // for the events that pass it.
+  std::string filter;
+};
+
+Workload getDefaultWorkload() {
   const std::array<std::string_view, 8> containers = {"Electrons",
                                                       "Photons",
                                                       "TauJets",
@@ -56,84 +101,1468 @@ void bmRDFReadspeed(ROOT::RDataFrame &rdf, bool isRNTuple) {
                                                       "DiTauJetsLowPt",
                                                       "TauNeutralParticleFlowObjects",
                                                       "TauNeutralParticleFlowObjects_MuonRM"};
-  const std::string sep = isRNTuple ? "_" : ".";
+  const std::array<std::string_view, 4> kinematics = {"pt", "eta", "phi", "m"};
+
+  Workload workload;
+  for (const auto c : containers) {
+    for (const auto k : kinematics) {
+      workload.columnPatterns.emplace_back(std::string(c) + "AuxDyn." + std::string(k));
+    }
+  }
+  return workload;
+}
+
+// Workload files are line-based, with one directive per line:
+//   column REGEX  -- read all columns matching REGEX (can be given multiple times)
+//   fraction F    -- only read a fraction 0 < F <= 1 of the matching columns
+//   filter EXPR   -- only read the non-filter columns for events passing EXPR
+// Empty lines and lines starting with '#' are ignored.
+bool readWorkload(const std::string &path, Workload &workload) {
+  std::ifstream file(path);
+  if (!file) {
+    std::cerr << "ERROR: could not open workload file " << path << std::endl;
+    return false;
+  }
+
+  workload = Workload();
+  std::string line;
+  while (std::getline(file, line)) {
+    std::stringstream ss(line);
+    std::string directive, value;
+    ss >> directive;
+    std::getline(ss >> std::ws, value);
+
+    if (directive.empty() || directive[0] == '#') {
+      continue;
+    } else if (directive == "column") {
+      workload.columnPatterns.emplace_back(value);
+    } else if (directive == "fraction") {
+      workload.fraction = std::atof(value.c_str());
+    } else if (directive == "filter") {
+      workload.filter = value;
+    } else {
+      std::cerr << "ERROR: unknown workload directive " << directive << std::endl;
+      return false;
+    }
+  }
+
+  if (workload.columnPatterns.empty() || workload.fraction <= 0. || workload.fraction > 1.) {
+    std::cerr << "ERROR: invalid workload " << path << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+// Branch names in filter expressions are given in their TTree form. For RNTuple, the dots that
+// separate the container from its member are converted in the same way as by the RNTupleImporter.
+std::string getFilterExpression(const Workload &workload, bool isRNTuple) {
+  if (!isRNTuple)
+    return workload.filter;
+  return std::regex_replace(workload.filter, std::regex(R"((\w+Aux(Dyn)?)\.(\w+))"), "$1_$3");
+}
+
+std::unique_ptr<ROOT::RDataFrame> openDataFrame(const std::string &inputPath,
+                                                const std::string &storeName, bool isRNTuple) {
+  if (isRNTuple) {
+    return std::make_unique<ROOT::RDataFrame>(
+        ROOT::RDF::Experimental::FromRNTuple(storeName, inputPath));
+  }
+  return std::make_unique<ROOT::RDataFrame>(storeName, inputPath);
+}
+
+bool isFloatVectorType(const std::string &typeName) {
+  static const std::regex floatVecRegex(R"((ROOT::VecOps::RVec|std::vector|vector)<float>)");
+  return std::regex_match(typeName, floatVecRegex);
+}
+
+std::vector<std::string> getColumnNames(const Workload &workload, const std::string &inputPath,
+                                        const std::string &storeName, bool isRNTuple) {
+  auto rdf = openDataFrame(inputPath, storeName, isRNTuple);
+
+  std::vector<std::regex> patterns;
+  for (const auto &p : workload.columnPatterns) {
+    patterns.emplace_back(p);
+  }
+
+  std::vector<std::string> columnNames;
+  for (const auto &col : rdf->GetColumnNames()) {
+    // Skip the collection size columns that RDataFrame adds for RNTuple.
+    if (col[0] == '#')
+      continue;
+    if (std::any_of(patterns.begin(), patterns.end(),
+                    [&col](const auto &p) { return std::regex_match(col, p); }))
+      columnNames.emplace_back(col);
+  }
+
+  if (workload.fraction < 1.) {
+    const std::size_t nSelected =
+        std::max<std::size_t>(1, std::ceil(columnNames.size() * workload.fraction));
+    std::vector<std::size_t> indices(columnNames.size());
+    std::iota(indices.begin(), indices.end(), 0);
+    std::shuffle(indices.begin(), indices.end(), std::mt19937(42));
+    indices.resize(nSelected);
+    std::sort(indices.begin(), indices.end());
+
+    std::vector<std::string> selected;
+    for (const auto i : indices) {
+      selected.emplace_back(columnNames[i]);
+    }
+    columnNames = selected;
+  }
+
+  return columnNames;
+}
+
+// Compressed (on-disk) size of the columns that are read, used to express the throughput in MB/s
+// independent of the number of threads and of what the format reports itself.
+std::uint64_t getColumnBytes(const std::vector<std::string> &columnNames,
+                             const std::vector<std::string> &inputPaths,
+                             const std::string &storeName, bool isRNTuple) {
+  std::uint64_t nBytes = 0;
+
+  for (const auto &inputPath : inputPaths) {
+    if (isRNTuple) {
+      auto inspector = RNTupleInspector::Create(storeName, inputPath);
+      const auto &descriptor = *inspector->GetDescriptor();
+      std::set<std::string> collections;
+      for (const auto &col : columnNames) {
+        nBytes += inspector->GetFieldTreeInfo(col).GetOnDiskSize();
+
+        // Members of a collection with a shared offset column (see bm_dedup_index) do not have an
+        // offset column of their own, but the one of the collection is read as well. It is counted
+        // once per collection, so the size is comparable to that of separate vector fields.
+        const auto dot = col.find('.');
+        if (dot == std::string::npos || !collections.insert(col.substr(0, dot)).second)
+          continue;
+        const auto collectionId = descriptor.FindFieldId(col.substr(0, dot));
+        const auto offsetColumnId = descriptor.FindPhysicalColumnId(collectionId, 0);
+        nBytes += inspector->GetColumnInfo(offsetColumnId).GetOnDiskSize();
+      }
+    } else {
+      auto file = std::unique_ptr<TFile>(TFile::Open(inputPath.c_str()));
+      auto tree = file->Get<TTree>(storeName.c_str());
+      for (const auto &col : columnNames) {
+        if (auto br = tree->GetBranch(col.c_str()))
+          nBytes += br->GetZipBytes("*");
+      }
+    }
+  }
 
+  return nBytes;
+}
+
+int getCompressionSettings(const std::string &inputPath, const std::string &storeName,
+                           bool isRNTuple) {
+  if (isRNTuple)
+    return RNTupleInspector::Create(storeName, inputPath)->GetCompressionSettings();
+
+  auto file = std::unique_ptr<TFile>(TFile::Open(inputPath.c_str()));
+  return file->GetCompressionSettings();
+}
+
+// How the columns are read. Besides RDataFrame, the columns can be read with the "native"
+// interfaces of each format, to separate the format's decoding throughput from the event loop
+// overhead:
+//   reader -- RNTupleReader views of std::vector<float> (RNTuple) or TTreeReaderArray (TTree)
+//   direct -- RNTuple collection views that read the items element-wise without materializing the
+//             vectors (RNTuple) or TBranch::GetEntry into std::vector<float> (TTree)
+// The native interfaces only support std::vector<float> columns and ignore the workload filter.
+enum class EAccessMethod { kRDF, kReader, kDirect };
+
+// What is done with the values that are read: fill a histogram per column, or sum them.
+enum class EKernel { kHisto, kSum };
+
+// I/O settings of the formats, which can be compared on the same file in a single invocation:
+//   default  -- the default settings of the format
+//   nocache  -- RNTuple: no cluster cache, i.e. every page is read with a separate read call;
+//               TTree: no TTreeCache, i.e. every basket is read with a separate read call
+//   bunchN   -- RNTuple: cluster cache that reads N clusters at a time in a single vector read
+//   cacheN   -- TTree: TTreeCache of N MB
+//   unzip[N] -- TTree: TTreeCache (of N MB) that decompresses the baskets in parallel
+//               (TTreeCacheUnzip)
+struct IOStrategy {
+  std::string name = "default";
+  bool useCache = true;
+  unsigned clusterBunchSize = 0; // RNTuple, 0 for the default
+  Long64_t cacheSize = -1;       // TTree, in bytes, -1 for the default
+  bool parallelUnzip = false;    // TTree
+};
+
+bool parseIOStrategy(const std::string &spec, bool isRNTuple, IOStrategy &strategy) {
+  std::smatch match;
+  if (!std::regex_match(spec, match, std::regex(R"((default|nocache|bunch|cache|unzip)(\d*))")))
+    return false;
+
+  const auto kind = match[1].str();
+  const bool hasSize = match[2].length() > 0;
+  const auto size = hasSize ? std::atol(match[2].str().c_str()) : 0;
+
+  strategy = IOStrategy();
+  strategy.name = spec;
+  if (kind == "default" || kind == "nocache") {
+    strategy.useCache = kind == "default";
+    return !hasSize;
+  }
+
+  if (isRNTuple) {
+    strategy.clusterBunchSize = size;
+    return kind == "bunch" && size > 0;
+  }
+
+  if (kind == "bunch" || (kind == "cache" && !hasSize) || (hasSize && size == 0))
+    return false;
+  if (hasSize)
+    strategy.cacheSize = size * 1000 * 1000;
+  strategy.parallelUnzip = kind == "unzip";
+  return true;
+}
+
+RNTupleReadOptions getReadOptions(const IOStrategy &strategy) {
+  RNTupleReadOptions options;
+  if (!strategy.useCache) {
+    options.SetClusterCache(RNTupleReadOptions::EClusterCache::kOff);
+  } else if (strategy.clusterBunchSize > 0) {
+    options.SetClusterCache(RNTupleReadOptions::EClusterCache::kOn);
+    options.SetClusterBunchSize(strategy.clusterBunchSize);
+  }
+  return options;
+}
+
+// Note that with implicit multi-threading, RDataFrame opens a separate tree for each task, so the
+// cache settings only apply to single-threaded RDataFrame reads (which is checked in main).
+void applyIOStrategy(TTree &tree, const IOStrategy &strategy) {
+  // Parallel unzipping is a global setting, which is picked up when the cache is created.
+  tree.SetParallelUnzip(strategy.parallelUnzip);
+  if (strategy.name == "default")
+    return;
+
+  // Drop the cache that may have been created when loading the tree, so it is created again with
+  // the requested size and type.
+  tree.SetCacheSize(0);
+  if (strategy.useCache)
+    tree.SetCacheSize(strategy.cacheSize);
+}
+
+// Whether ROOT reads vectors of byte ranges from local files (i.e. the clusters loaded by the
+// RNTuple cluster cache) with io_uring. This is decided when ROOT is built, so it is only reported.
+bool hasIoUring() {
+  return std::string(gROOT->GetConfigFeatures()).find("uring") != std::string::npos;
+}
+
+struct ReadspeedConfig {
+  std::vector<std::string> inputPaths;
+  std::string storeName = "CollectionTree";
+  bool isRNTuple = false;
+  std::vector<std::string> columnNames;
+  std::string filter;
+  unsigned nRepetitions = 1;
+  unsigned nWarmupRuns = 0;
+  bool coldCache = false;
+  EAccessMethod access = EAccessMethod::kRDF;
+  EKernel kernel = EKernel::kHisto;
+  // Read each column in a separate event loop instead, to break down the read cost per column.
+  bool profileColumns = false;
+  IOStrategy ioStrategy;
+  // Only used to tag the results.
+  std::string medium = "unknown";
+  int compression = -1;
+  std::uint64_t columnBytes = 0;
+  EOutputFormat outputFormat = EOutputFormat::kText;
+};
+
+// Sum with independent partial sums, which allows the compiler to vectorize the loop without
+// relaxing the floating point semantics (i.e. without -ffast-math).
+inline double sumFloats(const float *vals, std::size_t n) {
+  constexpr std::size_t kLanes = 8;
+  float partialSums[kLanes] = {};
+
+  std::size_t i = 0;
+  for (; i + kLanes <= n; i += kLanes) {
+    for (std::size_t l = 0; l < kLanes; ++l)
+      partialSums[l] += vals[i + l];
+  }
+
+  double sum = 0.;
+  for (; i < n; ++i)
+    sum += vals[i];
+  for (std::size_t l = 0; l < kLanes; ++l)
+    sum += partialSums[l];
+  return sum;
+}
+
+std::uint64_t bmRDFReadspeed(ROOT::RDataFrame &rdf, const ReadspeedConfig &config) {
   // Need to get access to the RInterface object.
   auto rdfEL = rdf.Define("NOOP", []() { return true; });
+  auto nEvents = rdfEL.Count();
+
+  ROOT::RDF::RNode rdfSel = rdfEL;
+  if (!config.filter.empty())
+    rdfSel = rdfEL.Filter(config.filter);
+
   std::vector<ROOT::RDF::RResultPtr<TH1D>> hists;
+  std::vector<ROOT::RDF::RResultPtr<double>> sums;
 
-  for (const auto c : containers) {
-    hists.emplace_back(rdfEL.Histo1D<ROOT::RVec<float>>({"hPt", "hPt", 128, 0, 20000}, std::string(c) + "AuxDyn" + sep + "pt"));
-    hists.emplace_back(rdfEL.Histo1D<ROOT::RVec<float>>({"hEta", "hEta", 128, 0, 20000}, std::string(c) + "AuxDyn" + sep + "eta"));
-    hists.emplace_back(rdfEL.Histo1D<ROOT::RVec<float>>({"hPhi", "hPhi", 128, 0, 20000}, std::string(c) + "AuxDyn" + sep + "phi"));
-    hists.emplace_back(rdfEL.Histo1D<ROOT::RVec<float>>({"hM", "hM", 128, 0, 20000}, std::string(c) + "AuxDyn" + sep + "m"));
+  // Vectors of floats (the default workload) are filled without jitting, to keep the event loop
+  // comparable to earlier results. Other columns that can be histogrammed are filled through a
+  // jitted action, the remaining ones (e.g. nested vectors) are only read.
+  const std::regex fillableRegex(
+      R"(((ROOT::VecOps::RVec|std::vector|vector)<)?)"
+      R"((bool|char|short|int|long|float|double|(unsigned )?(char|short|int|long|long long)|)"
+      R"((std::)?u?int(8|16|32|64)_t|[A-Za-z0-9]+_t)>?)");
+
+  for (const auto &col : config.columnNames) {
+    const auto colType = rdfEL.GetColumnType(col);
+    const auto sumCol = "sum_" + std::to_string(sums.size());
+    if (isFloatVectorType(colType)) {
+      if (config.kernel == EKernel::kSum) {
+        sums.emplace_back(rdfSel
+                              .Define(sumCol,
+                                      [](const ROOT::RVec<float> &v) {
+                                        return sumFloats(v.data(), v.size());
+                                      },
+                                      {col})
+                              .Sum<double>(sumCol));
+      } else {
+        hists.emplace_back(rdfSel.Histo1D<ROOT::RVec<float>>({"h", "h", 128, 0, 20000}, col));
+      }
+    } else if (std::regex_match(colType, fillableRegex)) {
+      hists.emplace_back(rdfSel.Histo1D({"h", "h", 128, 0, 20000}, col));
+    } else {
+      sums.emplace_back(rdfSel.Define(sumCol, "(void)" + col + "; return 1.;").Sum(sumCol));
+    }
+  }
+
+  if (!config.filter.empty()) {
+    std::cerr << "Events selected: " << *rdfSel.Count() << std::endl;
+  }
+
+  return *nEvents;
+}
+
+std::uint64_t bmNTupleReadspeed(RNTupleReader &reader, const ReadspeedConfig &config) {
+  const auto nColumns = config.columnNames.size();
+  std::vector<TH1D> hists;
+  hists.reserve(nColumns);
+  for (std::size_t i = 0; i < nColumns; ++i) {
+    hists.emplace_back("h", "h", 128, 0, 20000);
+  }
+  double sum = 0.;
+
+  if (config.access == EAccessMethod::kReader) {
+    std::vector<RNTupleView<std::vector<float>>> views;
+    for (const auto &col : config.columnNames) {
+      views.emplace_back(reader.GetView<std::vector<float>>(col));
+    }
+
+    for (auto i : reader.GetEntryRange()) {
+      for (std::size_t c = 0; c < nColumns; ++c) {
+        const auto &vals = views[c](i);
+        if (config.kernel == EKernel::kSum) {
+          sum += sumFloats(vals.data(), vals.size());
+        } else {
+          for (const auto v : vals)
+            hists[c].Fill(v);
+        }
+      }
+    }
+  } else {
+    std::vector<RNTupleViewCollection> collectionViews;
+    std::vector<RNTupleView<float>> itemViews;
+    for (const auto &col : config.columnNames) {
+      // Members of a collection with a shared offset column (see bm_dedup_index) are named
+      // COLLECTION.MEMBER, all other columns are std::vector<float> fields.
+      const auto dot = col.find('.');
+      if (dot == std::string::npos) {
+        collectionViews.emplace_back(reader.GetViewCollection(col));
+        itemViews.emplace_back(collectionViews.back().GetView<float>("_0"));
+      } else {
+        collectionViews.emplace_back(reader.GetViewCollection(col.substr(0, dot)));
+        itemViews.emplace_back(collectionViews.back().GetView<float>(col.substr(dot + 1)));
+      }
+    }
+
+    for (auto i : reader.GetEntryRange()) {
+      for (std::size_t c = 0; c < nColumns; ++c) {
+        for (auto j : collectionViews[c].GetCollectionRange(i)) {
+          if (config.kernel == EKernel::kSum)
+            sum += itemViews[c](j);
+          else
+            hists[c].Fill(itemViews[c](j));
+        }
+      }
+    }
+  }
+
+  // Make sure the reduction cannot be optimized away.
+  if (config.kernel == EKernel::kSum)
+    std::cerr << "Sum of values: " << sum << std::endl;
+
+  return reader.GetNEntries();
+}
+
+std::uint64_t bmTreeReadspeed(TTree &tree, const ReadspeedConfig &config) {
+  const auto nColumns = config.columnNames.size();
+  std::vector<TH1D> hists;
+  hists.reserve(nColumns);
+  for (std::size_t i = 0; i < nColumns; ++i) {
+    hists.emplace_back("h", "h", 128, 0, 20000);
+  }
+  double sum = 0.;
+
+  if (config.access == EAccessMethod::kReader) {
+    TTreeReader reader(&tree);
+    std::vector<std::unique_ptr<TTreeReaderArray<float>>> arrays;
+    for (const auto &col : config.columnNames) {
+      arrays.emplace_back(std::make_unique<TTreeReaderArray<float>>(reader, col.c_str()));
+    }
+
+    while (reader.Next()) {
+      for (std::size_t c = 0; c < nColumns; ++c) {
+        auto &arr = *arrays[c];
+        const auto size = arr.GetSize();
+        if (config.kernel == EKernel::kSum && size > 0 && arr.IsContiguous()) {
+          sum += sumFloats(&arr[0], size);
+        } else if (config.kernel == EKernel::kSum) {
+          for (const auto v : arr)
+            sum += v;
+        } else {
+          for (const auto v : arr)
+            hists[c].Fill(v);
+        }
+      }
+    }
+  } else {
+    std::vector<TBranch *> branches;
+    std::vector<std::vector<float> *> vals(nColumns, nullptr);
+    tree.SetBranchStatus("*", false);
+    for (std::size_t c = 0; c < nColumns; ++c) {
+      const auto &col = config.columnNames[c];
+      tree.SetBranchStatus(col.c_str(), true);
+      tree.SetBranchAddress(col.c_str(), &vals[c]);
+      if (config.ioStrategy.useCache)
+        tree.AddBranchToCache(col.c_str(), true);
+      branches.emplace_back(nullptr);
+    }
+    if (config.ioStrategy.useCache)
+      tree.StopCacheLearningPhase();
+
+    int treeNumber = -1;
+    for (Long64_t i = 0; i < tree.GetEntries(); ++i) {
+      // Needed to keep the TTreeCache in sync with the entries that are read, and in case of a
+      // chain, to get the entry number in the current tree.
+      const auto localEntry = tree.LoadTree(i);
+      if (tree.GetTreeNumber() != treeNumber) {
+        treeNumber = tree.GetTreeNumber();
+        for (std::size_t c = 0; c < nColumns; ++c) {
+          branches[c] = tree.GetTree()->GetBranch(config.columnNames[c].c_str());
+          if (!branches[c]) {
+            throw std::runtime_error("column " + config.columnNames[c] + " is missing in " +
+                                     tree.GetTree()->GetCurrentFile()->GetName());
+          }
+        }
+      }
+
+      for (std::size_t c = 0; c < nColumns; ++c) {
+        branches[c]->GetEntry(localEntry);
+        if (config.kernel == EKernel::kSum) {
+          sum += sumFloats(vals[c]->data(), vals[c]->size());
+        } else {
+          for (const auto v : *vals[c])
+            hists[c].Fill(v);
+        }
+      }
+    }
+
+    tree.ResetBranchAddresses();
+  }
+
+  // Make sure the reduction cannot be optimized away.
+  if (config.kernel == EKernel::kSum)
+    std::cerr << "Sum of values: " << sum << std::endl;
+
+  return tree.GetEntries();
+}
+
+struct ReadspeedStats {
+  double mean;
+  double median;
+  double stddev;
+  double min;
+  double p95;
+};
+
+struct EventLoopResult {
+  std::uint64_t nEvents;
+  double wallTime; // in seconds
+  long rssBefore;  // in kB, resident set size of the process before the event loop
+  long maxRSS;     // in kB, peak resident set size of the process during the event loop
+  // Only available when built with ATLAS_BM_COUNT_ALLOCATIONS.
+  AllocationStats allocations;
+  // I/O counters reported by the format itself.
+  MetricsRecord_t counters;
+};
+
+struct FileOpenResult {
+  std::string inputPath;
+  std::vector<double> openTimes; // in seconds, one per (non-warm-up) repetition
+};
+
+struct ReadspeedResult {
+  unsigned nThreads;
+  std::string ioStrategy;
+  std::vector<EventLoopResult> runs; // one per (non-warm-up) repetition
+};
+
+ReadspeedStats computeStats(std::vector<double> vals) {
+  std::sort(vals.begin(), vals.end());
+  const auto n = vals.size();
+
+  ReadspeedStats stats;
+  stats.mean = std::accumulate(vals.begin(), vals.end(), 0.) / n;
+  stats.median = n % 2 ? vals[n / 2] : (vals[n / 2 - 1] + vals[n / 2]) / 2.;
+  stats.min = vals.front();
+  // Nearest-rank percentile.
+  stats.p95 = vals[static_cast<std::size_t>(std::ceil(0.95 * n)) - 1];
+
+  double sumSq = 0.;
+  for (const auto v : vals) {
+    sumSq += (v - stats.mean) * (v - stats.mean);
+  }
+  stats.stddev = n > 1 ? std::sqrt(sumSq / (n - 1)) : 0.;
+
+  return stats;
+}
+
+ReadspeedStats computeWallTimeStats(const ReadspeedResult &result) {
+  std::vector<double> wallTimes;
+  for (const auto &run : result.runs) {
+    wallTimes.emplace_back(run.wallTime);
+  }
+  return computeStats(wallTimes);
+}
+
+// Evicts the input file from the page cache, so the next event loop reads it from the storage
+// medium. Unlike dropping all caches, this does not require root privileges.
+bool evictFromPageCache(const std::string &path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+  int rv = posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+  close(fd);
+  return rv == 0;
+}
+
+// RNTupleMetrics does not provide access to the list of its counters, but its printout has a fixed
+// NAME|UNIT|DESCRIPTION|VALUE format, so this is used to collect all of them. The given prefix is
+// removed from the counter names, so the page source counters have the same names whether they are
+// collected from the page source itself or from the reader that owns it.
+void addNTupleCounters(const RNTupleMetrics &metrics, MetricsRecord_t &counters,
+                       const std::string &prefix = "") {
+  std::stringstream ss;
+  metrics.Print(ss);
+
+  std::string line;
+  while (std::getline(ss, line)) {
+    const auto first = line.find('|');
+    const auto last = line.rfind('|');
+    if (first == std::string::npos)
+      continue;
+
+    auto name = line.substr(0, first);
+    if (name.compare(0, prefix.size(), prefix) == 0)
+      name.erase(0, prefix.size());
+    const auto value = line.substr(last + 1);
+    char *end;
+    const double numValue = std::strtod(value.c_str(), &end);
+    if (!value.empty() && *end == '\0')
+      addMetric(counters, name, numValue);
+    else
+      addMetric(counters, name, value);
+  }
+}
+
+void addTreeCounters(TTreePerfStats &treeStats, TFile &file, TTree &tree,
+                     MetricsRecord_t &counters) {
+  treeStats.Finish();
+  addMetric(counters, "TTreePerfStats.readCalls", treeStats.GetReadCalls());
+  addMetric(counters, "TTreePerfStats.bytesRead", treeStats.GetBytesRead());
+  addMetric(counters, "TTreePerfStats.bytesReadExtra", treeStats.GetBytesReadExtra());
+  addMetric(counters, "TTreePerfStats.readaheadSize", treeStats.GetReadaheadSize());
+  addMetric(counters, "TTreePerfStats.treeCacheSize", treeStats.GetTreeCacheSize());
+  addMetric(counters, "TTreePerfStats.realTime", treeStats.GetRealTime());
+  addMetric(counters, "TTreePerfStats.cpuTime", treeStats.GetCpuTime());
+  addMetric(counters, "TTreePerfStats.diskTime", treeStats.GetDiskTime());
+  addMetric(counters, "TTreePerfStats.unzipTime", treeStats.GetUnzipTime());
+  addMetric(counters, "TTreePerfStats.compress", treeStats.GetCompress());
+
+  if (auto cache = dynamic_cast<TTreeCache *>(file.GetCacheRead(&tree))) {
+    addMetric(counters, "TTreeCache.efficiency", cache->GetEfficiency());
+    addMetric(counters, "TTreeCache.efficiencyRel", cache->GetEfficiencyRel());
+    addMetric(counters, "TTreeCache.bufferSize", cache->GetBufferSize());
+  }
+
+  // Memory held by the baskets of all branches at the end of the event loop. While reading, a
+  // branch only keeps its current basket(s) in memory, so this approximates the basket memory
+  // during the event loop.
+  std::uint64_t nBaskets = 0;
+  std::uint64_t basketBytes = 0;
+  for (auto leaf : TRangeDynCast<TLeaf>(tree.GetListOfLeaves())) {
+    if (!leaf || leaf->GetBranch()->GetListOfLeaves()->At(0) != leaf)
+      continue;
+    for (auto basket : TRangeDynCast<TBasket>(leaf->GetBranch()->GetListOfBaskets())) {
+      if (!basket)
+        continue;
+      ++nBaskets;
+      basketBytes += basket->GetBufferSize();
+    }
+  }
+  addMetric(counters, "TTree.basketsInMemory", nBaskets);
+  addMetric(counters, "TTree.basketBufferBytes", basketBytes);
+}
+
+double getSecondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Warm-up runs do not print anything (including the RDataFrame event loop log), so text-mode
+// consumers of the output only see the measured event loops.
+EventLoopResult runEventLoop(const ReadspeedConfig &config, bool isMT, bool isWarmup = false) {
+  EventLoopResult result;
+  const bool printText =
+      config.outputFormat == EOutputFormat::kText && !config.profileColumns && !isWarmup;
+  std::optional<ROOT::Experimental::RLogScopedVerbosity> warmupVerbosity;
+  if (isWarmup)
+    warmupVerbosity.emplace(ROOT::Detail::RDF::RDFLogChannel(),
+                            ROOT::Experimental::ELogLevel::kWarning);
+  // I/O counters are only collected for a single input file.
+  const bool isChain = config.inputPaths.size() > 1;
+
+  if (config.isRNTuple && isChain) {
+    if (config.access == EAccessMethod::kRDF) {
+      ROOT::RDataFrame rdf =
+          ROOT::RDF::Experimental::FromRNTuple(config.storeName, config.inputPaths);
+      auto start = std::chrono::steady_clock::now();
+      result.nEvents = bmRDFReadspeed(rdf, config);
+      result.wallTime = getSecondsSince(start);
+    } else {
+      // Like for the chain, all files are opened before the event loop.
+      std::vector<std::unique_ptr<RNTupleReader>> readers;
+      for (const auto &inputPath : config.inputPaths) {
+        readers.emplace_back(RNTupleReader::Open(config.storeName, inputPath,
+                                                 getReadOptions(config.ioStrategy)));
+      }
+      auto start = std::chrono::steady_clock::now();
+      result.nEvents = 0;
+      for (auto &reader : readers) {
+        result.nEvents += bmNTupleReadspeed(*reader, config);
+      }
+      result.wallTime = getSecondsSince(start);
+    }
+  } else if (config.isRNTuple) {
+    if (config.access == EAccessMethod::kRDF) {
+      // The data source is created from a page source with metrics enabled, to get the I/O
+      // counters from the same page source that is read from. With multiple threads, the page
+      // sources of the other slots are clones without enabled metrics, so only the counters of the
+      // first slot are available.
+      auto pageSource = RPageSource::Create(config.storeName, config.inputPaths[0],
+                                            getReadOptions(config.ioStrategy));
+      auto &metrics = pageSource->GetMetrics();
+      metrics.Enable();
+
+      ROOT::RDataFrame rdf(std::make_unique<ROOT::Experimental::RNTupleDS>(std::move(pageSource)));
+      auto start = std::chrono::steady_clock::now();
+      result.nEvents = bmRDFReadspeed(rdf, config);
+      result.wallTime = getSecondsSince(start);
+
+      addNTupleCounters(metrics, result.counters);
+      if (printText)
+        metrics.Print(std::cout, "RDF.");
+    } else {
+      // With implicit multi-threading enabled, the reader decompresses pages in parallel. Its
+      // metrics include those of its page source.
+      auto reader = RNTupleReader::Open(config.storeName, config.inputPaths[0],
+                                        getReadOptions(config.ioStrategy));
+      reader->EnableMetrics();
+      auto start = std::chrono::steady_clock::now();
+      result.nEvents = bmNTupleReadspeed(*reader, config);
+      result.wallTime = getSecondsSince(start);
+
+      addNTupleCounters(reader->GetMetrics(), result.counters, "RNTupleReader.");
+      if (printText)
+        reader->GetMetrics().Print(std::cout, "RDF.");
+    }
+  } else if (isChain) {
+    TChain chain(config.storeName.c_str());
+    for (const auto &inputPath : config.inputPaths) {
+      chain.Add(inputPath.c_str());
+    }
+    // Opens all files to count the entries, which should not be part of the event loop.
+    chain.GetEntries();
+
+    if (config.access == EAccessMethod::kRDF) {
+      ROOT::RDataFrame rdf(chain);
+      auto start = std::chrono::steady_clock::now();
+      result.nEvents = bmRDFReadspeed(rdf, config);
+      result.wallTime = getSecondsSince(start);
+    } else {
+      auto start = std::chrono::steady_clock::now();
+      result.nEvents = bmTreeReadspeed(chain, config);
+      result.wallTime = getSecondsSince(start);
+    }
+  } else {
+    auto file = std::unique_ptr<TFile>(TFile::Open(config.inputPaths[0].c_str()));
+    auto tree = file->Get<TTree>(config.storeName.c_str());
+    applyIOStrategy(*tree, config.ioStrategy);
+    // Per-basket statistics are only collected for the tree in the main thread.
+    std::unique_ptr<TTreePerfStats> treeStats;
+    if (!isMT)
+      treeStats = std::make_unique<TTreePerfStats>("ioperf", tree);
+
+    if (config.access == EAccessMethod::kRDF) {
+      ROOT::RDataFrame rdf(*tree);
+      auto start = std::chrono::steady_clock::now();
+      result.nEvents = bmRDFReadspeed(rdf, config);
+      result.wallTime = getSecondsSince(start);
+    } else {
+      auto start = std::chrono::steady_clock::now();
+      result.nEvents = bmTreeReadspeed(*tree, config);
+      result.wallTime = getSecondsSince(start);
+    }
+
+    if (treeStats) {
+      addTreeCounters(*treeStats, *file, *tree, result.counters);
+      if (printText)
+        treeStats->Print();
+      // The tree does not own its perf stats, so detach them before they are deleted.
+      tree->SetPerfStats(nullptr);
+    }
+  }
+
+  if (printText)
+    std::cout << "Events processed: " << result.nEvents << std::endl;
+
+  return result;
+}
+
+// Time needed to open a file and deserialize the metadata required to start reading, i.e. the keys
+// list and TTree (including the basket index) for TTree, or the anchor, header and footer for
+// RNTuple.
+double measureOpenTime(const std::string &inputPath, const std::string &storeName, bool isRNTuple) {
+  auto start = std::chrono::steady_clock::now();
+  if (isRNTuple) {
+    auto pageSource = RPageSource::Create(storeName, inputPath);
+    pageSource->Attach();
+  } else {
+    auto file = std::unique_ptr<TFile>(TFile::Open(inputPath.c_str()));
+    auto tree = file->Get<TTree>(storeName.c_str());
+    tree->GetEntries();
+  }
+  return getSecondsSince(start);
+}
+
+std::vector<FileOpenResult> runOpenBenchmark(const ReadspeedConfig &config) {
+  std::vector<FileOpenResult> results;
+
+  for (const auto &inputPath : config.inputPaths) {
+    FileOpenResult result{inputPath, {}};
+    for (unsigned i = 0; i < config.nWarmupRuns + config.nRepetitions; ++i) {
+      if (config.coldCache)
+        evictFromPageCache(inputPath);
+
+      const double openTime = measureOpenTime(inputPath, config.storeName, config.isRNTuple);
+      if (i >= config.nWarmupRuns)
+        result.openTimes.emplace_back(openTime);
+    }
+    results.emplace_back(std::move(result));
+  }
+
+  return results;
+}
+
+ReadspeedResult runReadspeed(const ReadspeedConfig &config, unsigned nThreads) {
+  // With a single thread, run the event loop sequentially instead of through the (single-slot)
+  // task arena, so the result is comparable to the serial numbers of earlier runs.
+  const bool isMT = nThreads > 1;
+  if (isMT)
+    ROOT::EnableImplicitMT(nThreads);
+
+  ReadspeedResult result{nThreads, config.ioStrategy.name, {}};
+
+  for (unsigned i = 0; i < config.nWarmupRuns + config.nRepetitions; ++i) {
+    for (const auto &inputPath : config.inputPaths) {
+      if (config.coldCache && !evictFromPageCache(inputPath)) {
+        std::cerr << "WARNING: could not evict " << inputPath << " from the page cache"
+                  << std::endl;
+      }
+    }
+
+    resetPeakRSS();
+    const long rssBefore = getCurrentRSS();
+    resetAllocationStats();
+    const bool isWarmup = i < config.nWarmupRuns;
+    auto run = runEventLoop(config, isMT, isWarmup);
+    run.allocations = getAllocationStats();
+    run.maxRSS = getPeakRSS();
+    run.rssBefore = rssBefore;
+    if (!isWarmup)
+      result.runs.emplace_back(std::move(run));
+  }
+
+  if (isMT)
+    ROOT::DisableImplicitMT();
+
+  return result;
+}
+
+std::string getAccessMethodName(EAccessMethod access) {
+  switch (access) {
+  case EAccessMethod::kReader:
+    return "reader";
+  case EAccessMethod::kDirect:
+    return "direct";
+  default:
+    return "rdf";
   }
+}
+
+struct ColumnCost {
+  std::string columnName;
+  std::uint64_t columnBytes; // compressed size on disk
+  double bytesRead;          // as reported by the format, including overhead
+  double wallTime;           // in seconds, for the whole event loop
+  double readTime;           // in seconds
+  double unzipTime;          // in seconds
+  // Remaining time of the event loop, i.e. the deserialization of the column plus the (per-event)
+  // overhead of the access method.
+  double deserializeTime; // in seconds
+};
+
+double getCounter(const MetricsRecord_t &counters, const std::string &name) {
+  for (const auto &[key, val] : counters) {
+    if (key == name && val.isNumeric && val.value != "null")
+      return std::stod(val.value);
+  }
+  return 0.;
+}
+
+// Number of bytes read from storage as reported by the format, including the overhead (e.g. gaps
+// between the pages of a cluster, or baskets of other branches read by the TTreeCache).
+double getBytesRead(const MetricsRecord_t &counters, bool isRNTuple) {
+  if (isRNTuple)
+    return getCounter(counters, "RPageSourceFile.szReadPayload") +
+           getCounter(counters, "RPageSourceFile.szReadOverhead");
+  return getCounter(counters, "TTreePerfStats.bytesRead");
+}
 
+// Number of read calls, where a vector read counts as a single call.
+double getReadCalls(const MetricsRecord_t &counters, bool isRNTuple) {
+  if (isRNTuple)
+    return getCounter(counters, "RPageSourceFile.nReadV") +
+           getCounter(counters, "RPageSourceFile.nRead");
+  return getCounter(counters, "TTreePerfStats.readCalls");
+}
+
+// Reads a single column (single-threaded, without the workload filter) and attributes the wall time
+// of the event loop to reading, decompressing and deserializing it, based on the counters reported
+// by the format. Each quantity is the median over the repetitions.
+ColumnCost measureColumnCost(const ReadspeedConfig &config, const std::string &columnName) {
+  auto columnConfig = config;
+  columnConfig.columnNames = {columnName};
+  columnConfig.filter.clear();
+
+  std::vector<double> wallTimes, readTimes, unzipTimes, bytesRead;
+  for (unsigned i = 0; i < config.nWarmupRuns + config.nRepetitions; ++i) {
+    if (config.coldCache)
+      evictFromPageCache(config.inputPaths[0]);
 
+    const bool isWarmup = i < config.nWarmupRuns;
+    const auto run = runEventLoop(columnConfig, false, isWarmup);
+    if (isWarmup)
+      continue;
+
+    wallTimes.emplace_back(run.wallTime);
+    if (config.isRNTuple) {
+      // The RNTuple timers are in nanoseconds.
+      readTimes.emplace_back(getCounter(run.counters, "RPageSourceFile.timeWallRead") / 1e9);
+      unzipTimes.emplace_back(getCounter(run.counters, "RPageSourceFile.timeWallUnzip") / 1e9);
+    } else {
+      readTimes.emplace_back(getCounter(run.counters, "TTreePerfStats.diskTime"));
+      unzipTimes.emplace_back(getCounter(run.counters, "TTreePerfStats.unzipTime"));
+    }
+    bytesRead.emplace_back(getBytesRead(run.counters, config.isRNTuple));
+  }
 
-  std::cout << "Events processed: " << *rdfEL.Count() << std::endl;
+  ColumnCost cost;
+  cost.columnName = columnName;
+  cost.columnBytes =
+      getColumnBytes({columnName}, config.inputPaths, config.storeName, config.isRNTuple);
+  cost.bytesRead = computeStats(bytesRead).median;
+  cost.wallTime = computeStats(wallTimes).median;
+  cost.readTime = computeStats(readTimes).median;
+  cost.unzipTime = computeStats(unzipTimes).median;
+  // With the (asynchronous) RNTuple cluster pool, reading overlaps with the event loop.
+  cost.deserializeTime = std::max(0., cost.wallTime - cost.readTime - cost.unzipTime);
+  return cost;
+}
+
+// Returns the cost of all columns of the workload, most expensive (by wall time) first.
+std::vector<ColumnCost> runColumnProfile(const ReadspeedConfig &config) {
+  std::vector<ColumnCost> costs;
+  for (const auto &columnName : config.columnNames) {
+    costs.emplace_back(measureColumnCost(config, columnName));
+  }
+  std::sort(costs.begin(), costs.end(),
+            [](const auto &a, const auto &b) { return a.wallTime > b.wallTime; });
+  return costs;
+}
+
+void printColumnProfile(const std::vector<ColumnCost> &costs) {
+  double totalWallTime = 0.;
+  for (const auto &c : costs) {
+    totalWallTime += c.wallTime;
+  }
+
+  std::cout << "rank\tcolumn\twall_s\tshare\tcumulative_share\tcolumn_MB\tread_MB\tread_s\t"
+               "unzip_s\tdeserialize_s"
+            << std::endl;
+  double cumulativeWallTime = 0.;
+  for (std::size_t i = 0; i < costs.size(); ++i) {
+    const auto &c = costs[i];
+    cumulativeWallTime += c.wallTime;
+    std::cout << i + 1 << "\t" << c.columnName << "\t" << c.wallTime << "\t"
+              << c.wallTime / totalWallTime << "\t" << cumulativeWallTime / totalWallTime << "\t"
+              << c.columnBytes / 1e6 << "\t" << c.bytesRead / 1e6 << "\t" << c.readTime << "\t"
+              << c.unzipTime << "\t" << c.deserializeTime << std::endl;
+  }
+}
+
+std::vector<MetricsRecord_t> getColumnProfileRecords(const ReadspeedConfig &config,
+                                                     const std::vector<ColumnCost> &costs) {
+  std::vector<MetricsRecord_t> records;
+  for (std::size_t i = 0; i < costs.size(); ++i) {
+    const auto &c = costs[i];
+    MetricsRecord_t record;
+    addMetric(record, "record", "column");
+    addMetric(record, "file", config.inputPaths[0]);
+    addMetric(record, "format", config.isRNTuple ? "rntuple" : "ttree");
+    addMetric(record, "compression", config.compression);
+    addMetric(record, "medium", config.medium);
+    addMetric(record, "cold_cache", config.coldCache);
+    addMetric(record, "access", getAccessMethodName(config.access));
+    addMetric(record, "rank", i + 1);
+    addMetric(record, "column", c.columnName);
+    addMetric(record, "column_bytes", c.columnBytes);
+    addMetric(record, "bytes_read", c.bytesRead);
+    addMetric(record, "wall_time_s", c.wallTime);
+    addMetric(record, "read_time_s", c.readTime);
+    addMetric(record, "unzip_time_s", c.unzipTime);
+    addMetric(record, "deserialize_time_s", c.deserializeTime);
+    records.emplace_back(std::move(record));
+  }
+  return records;
+}
+
+long getMaxRSS(const ReadspeedResult &result) {
+  long maxRSS = 0;
+  for (const auto &run : result.runs)
+    maxRSS = std::max(maxRSS, run.maxRSS);
+  return maxRSS;
+}
+
+// The memory usage is the maximum over the repetitions, the number of allocations the median.
+void printRepetitionStats(const std::vector<ReadspeedResult> &results) {
+  std::cout << "threads\trepetitions\tmean_s\tmedian_s\tstddev_s\tmin_s\tp95_s\trss_before_mb\t"
+               "peak_rss_mb";
+  if (kCountAllocations)
+    std::cout << "\tallocations\tallocated_mb\tpeak_heap_mb";
+  std::cout << std::endl;
+
+  for (const auto &r : results) {
+    const auto stats = computeWallTimeStats(r);
+    long rssBefore = 0;
+    std::int64_t peakHeapBytes = 0;
+    std::vector<double> nAllocations, allocatedBytes;
+    for (const auto &run : r.runs) {
+      rssBefore = std::max(rssBefore, run.rssBefore);
+      peakHeapBytes = std::max(peakHeapBytes, run.allocations.peakBytes);
+      nAllocations.emplace_back(run.allocations.nAllocations);
+      allocatedBytes.emplace_back(run.allocations.allocatedBytes);
+    }
+
+    std::cout << r.nThreads << "\t" << r.runs.size() << "\t" << stats.mean << "\t" << stats.median
+              << "\t" << stats.stddev << "\t" << stats.min << "\t" << stats.p95 << "\t"
+              << rssBefore / 1e3 << "\t" << getMaxRSS(r) / 1e3;
+    if (kCountAllocations)
+      std::cout << "\t" << computeStats(nAllocations).median << "\t"
+                << computeStats(allocatedBytes).median / 1e6 << "\t" << peakHeapBytes / 1e6;
+    std::cout << std::endl;
+  }
+}
+
+// Rates are based on the median wall time of the repetitions. Parallel efficiency is computed with
+// respect to the run with the lowest thread count.
+void printScalingResults(const std::vector<ReadspeedResult> &results, std::uint64_t nBytes) {
+  auto ref = std::min_element(results.begin(), results.end(), [](const auto &a, const auto &b) {
+    return a.nThreads < b.nThreads;
+  });
+  const double refRate = ref->runs[0].nEvents / computeWallTimeStats(*ref).median;
+
+  std::cout << "threads\tevents\twall_s\tevents/s\tMB/s\tefficiency\tevents/s/GB_rss" << std::endl;
+  for (const auto &r : results) {
+    const auto nEvents = r.runs[0].nEvents;
+    const double wallTime = computeWallTimeStats(r).median;
+    const double rate = nEvents / wallTime;
+    const double efficiency = (rate / refRate) * ((double)ref->nThreads / r.nThreads);
+    // Throughput per GB of peak RSS, for nodes where the memory per slot is the limit.
+    const double ratePerGB = getMaxRSS(r) > 0 ? rate / (getMaxRSS(r) / 1e6) : 0.;
+    std::cout << r.nThreads << "\t" << nEvents << "\t" << wallTime << "\t" << rate << "\t"
+              << nBytes / 1e6 / wallTime << "\t" << efficiency << "\t" << ratePerGB << std::endl;
+  }
+}
+
+// Compares the I/O strategies by the median wall time, and by the median number of read calls and
+// bytes read reported by the format (only for single-threaded TTree reads and for the first slot of
+// RNTuple reads).
+void printIOStrategyComparison(const ReadspeedConfig &config,
+                               const std::vector<ReadspeedResult> &results) {
+  if (config.isRNTuple)
+    std::cout << "io_uring: " << (hasIoUring() ? "yes" : "no") << std::endl;
+
+  std::cout << "io_strategy\tthreads\tmedian_s\tevents/s\tMB/s\tread_calls\tread_MB\tpeak_rss_mb"
+            << std::endl;
+  for (const auto &r : results) {
+    std::vector<double> readCalls, bytesRead;
+    for (const auto &run : r.runs) {
+      readCalls.emplace_back(getReadCalls(run.counters, config.isRNTuple));
+      bytesRead.emplace_back(getBytesRead(run.counters, config.isRNTuple));
+    }
+
+    const double wallTime = computeWallTimeStats(r).median;
+    std::cout << r.ioStrategy << "\t" << r.nThreads << "\t" << wallTime << "\t"
+              << r.runs[0].nEvents / wallTime << "\t" << config.columnBytes / 1e6 / wallTime
+              << "\t" << computeStats(readCalls).median << "\t"
+              << computeStats(bytesRead).median / 1e6 << "\t" << getMaxRSS(r) / 1e3 << std::endl;
+  }
+}
+
+void printOpenStats(const std::vector<FileOpenResult> &results) {
+  std::cout << "file\tmean_open_s\tmedian_open_s\tmin_open_s" << std::endl;
+  for (const auto &r : results) {
+    const auto stats = computeStats(r.openTimes);
+    std::cout << r.inputPath << "\t" << stats.mean << "\t" << stats.median << "\t" << stats.min
+              << std::endl;
+  }
+}
+
+// One record per (non-warm-up) event loop, and per file and repetition for the time needed to open
+// the input files. The tags come first, followed by the timing and the I/O counters reported by the
+// format.
+std::vector<MetricsRecord_t> getRecords(const ReadspeedConfig &config,
+                                        const std::vector<ReadspeedResult> &results,
+                                        const std::vector<FileOpenResult> &openResults) {
+  std::vector<MetricsRecord_t> records;
+
+  std::string inputPaths;
+  for (const auto &inputPath : config.inputPaths) {
+    inputPaths += (inputPaths.empty() ? "" : ",") + inputPath;
+  }
+
+  for (const auto &r : openResults) {
+    for (std::size_t i = 0; i < r.openTimes.size(); ++i) {
+      MetricsRecord_t record;
+      addMetric(record, "record", "open");
+      addMetric(record, "file", r.inputPath);
+      addMetric(record, "format", config.isRNTuple ? "rntuple" : "ttree");
+      addMetric(record, "compression", config.compression);
+      addMetric(record, "medium", config.medium);
+      addMetric(record, "cold_cache", config.coldCache);
+      addMetric(record, "repetition", i);
+      addMetric(record, "open_time_s", r.openTimes[i]);
+      records.emplace_back(std::move(record));
+    }
+  }
+
+  for (const auto &r : results) {
+    for (std::size_t i = 0; i < r.runs.size(); ++i) {
+      const auto &run = r.runs[i];
+      MetricsRecord_t record;
+      addMetric(record, "record", "event_loop");
+      addMetric(record, "file", inputPaths);
+      addMetric(record, "files", config.inputPaths.size());
+      addMetric(record, "format", config.isRNTuple ? "rntuple" : "ttree");
+      addMetric(record, "compression", config.compression);
+      addMetric(record, "medium", config.medium);
+      addMetric(record, "threads", r.nThreads);
+      addMetric(record, "columns", config.columnNames.size());
+      addMetric(record, "cold_cache", config.coldCache);
+      addMetric(record, "access", getAccessMethodName(config.access));
+      addMetric(record, "kernel", config.kernel == EKernel::kSum ? "sum" : "histo");
+      addMetric(record, "io_strategy", r.ioStrategy);
+      if (config.isRNTuple)
+        addMetric(record, "io_uring", hasIoUring());
+      addMetric(record, "repetition", i);
+      addMetric(record, "events", run.nEvents);
+      addMetric(record, "wall_time_s", run.wallTime);
+      addMetric(record, "events_per_s", run.nEvents / run.wallTime);
+      addMetric(record, "column_bytes", config.columnBytes);
+      addMetric(record, "mb_per_s", config.columnBytes / 1e6 / run.wallTime);
+      addMetric(record, "rss_before_kb", run.rssBefore);
+      addMetric(record, "peak_rss_kb", run.maxRSS);
+      if (kCountAllocations) {
+        addMetric(record, "allocations", run.allocations.nAllocations);
+        addMetric(record, "allocated_bytes", run.allocations.allocatedBytes);
+        addMetric(record, "peak_heap_bytes", run.allocations.peakBytes);
+      }
+      record.insert(record.end(), run.counters.begin(), run.counters.end());
+      records.emplace_back(std::move(record));
+    }
+  }
+
+  return records;
+}
+
+// An input argument is either a path, a glob pattern or, when prefixed with '@', a file with one
+// path or pattern per line. Paths that are not on the local file system (e.g. root:// URLs) are
+// passed on as is.
+bool expandInputPaths(const std::string &arg, std::vector<std::string> &inputPaths) {
+  std::vector<std::string> patterns;
+  if (arg[0] == '@') {
+    std::ifstream listFile(arg.substr(1));
+    if (!listFile) {
+      std::cerr << "ERROR: could not open input list " << arg.substr(1) << std::endl;
+      return false;
+    }
+    std::string line;
+    while (std::getline(listFile, line)) {
+      if (!line.empty() && line[0] != '#')
+        patterns.emplace_back(line);
+    }
+  } else {
+    patterns.emplace_back(arg);
+  }
+
+  for (const auto &pattern : patterns) {
+    glob_t globResult;
+    if (glob(pattern.c_str(), GLOB_NOCHECK, nullptr, &globResult) != 0) {
+      std::cerr << "ERROR: could not expand input path " << pattern << std::endl;
+      return false;
+    }
+    for (std::size_t i = 0; i < globResult.gl_pathc; ++i) {
+      inputPaths.emplace_back(globResult.gl_pathv[i]);
+    }
+    globfree(&globResult);
+  }
+
+  return true;
+}
+
+std::vector<unsigned> parseThreadCounts(const std::string &arg) {
+  std::vector<unsigned> threadCounts;
+  std::stringstream ss(arg);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    int n = std::atoi(item.c_str());
+    if (n < 1)
+      return {};
+    threadCounts.emplace_back(n);
+  }
+  return threadCounts;
 }
 
 static void printUsage(std::string_view prog) {
-  std::cout << prog << " (-h|-i INPUT_PATH -s (ttree|rntuple) [-n STORE_NAME])" << std::endl;
+  std::cout << prog
+            << " (-h|-i INPUT_PATH [-i INPUT_PATH...] -s (ttree|rntuple) [-n STORE_NAME] "
+               "[-t N_THREADS[,N_THREADS...]] [-w WORKLOAD_FILE] [-f FRACTION] [-r N_REPETITIONS] "
+               "[-W N_WARMUP_RUNS] [-c] [-a (rdf|reader|direct)] [-k (histo|sum)] [-p] "
+               "[-I IO_STRATEGY[,IO_STRATEGY...]] [-m MEDIUM] [-o (text|json|csv)])"
+            << std::endl;
 }
 
 int main(int argc, char **argv) {
-  std::string inputPath;
-  std::string storeName = "CollectionTree";
-  bool isRNTuple = false;
+  ReadspeedConfig config;
+  std::vector<unsigned> threadCounts = {1};
+  Workload workload = getDefaultWorkload();
+  double fraction = 0.;
+  std::string ioStrategyList;
 
   int c;
-  while ((c = getopt(argc, argv, "hi:n:s:")) != -1) {
+  while ((c = getopt(argc, argv, "hi:n:s:t:w:f:r:W:ca:k:pI:m:o:")) != -1) {
     switch (c) {
     case 'h':
       printUsage(argv[0]);
       return 0;
     case 'i':
-      inputPath = optarg;
+      if (!expandInputPaths(optarg, config.inputPaths))
+        return 1;
       break;
     case 'n':
-      storeName = optarg;
+      config.storeName = optarg;
       break;
     case 's':
       if (strcmp(optarg, "rntuple") == 0) {
-        isRNTuple = true;
+        config.isRNTuple = true;
       } else if (strcmp(optarg, "ttree") != 0) {
         std::cerr << "Unknown mode: " << optarg << std::endl;
         return 1;
       }
       break;
+    case 't':
+      threadCounts = parseThreadCounts(optarg);
+      if (threadCounts.empty()) {
+        std::cerr << "ERROR: invalid thread count(s) " << optarg << std::endl;
+        return 1;
+      }
+      break;
+    case 'w':
+      if (!readWorkload(optarg, workload))
+        return 1;
+      break;
+    case 'f':
+      fraction = std::atof(optarg);
+      if (fraction <= 0. || fraction > 1.) {
+        std::cerr << "ERROR: the fraction of columns to read must be in (0, 1]" << std::endl;
+        return 1;
+      }
+      break;
+    case 'r':
+      if (std::atoi(optarg) < 1) {
+        std::cerr << "ERROR: the number of repetitions must be at least 1" << std::endl;
+        return 1;
+      }
+      config.nRepetitions = std::atoi(optarg);
+      break;
+    case 'W':
+      if (std::atoi(optarg) < 0) {
+        std::cerr << "ERROR: the number of warm-up runs cannot be negative" << std::endl;
+        return 1;
+      }
+      config.nWarmupRuns = std::atoi(optarg);
+      break;
+    case 'c':
+      config.coldCache = true;
+      break;
+    case 'a':
+      if (strcmp(optarg, "reader") == 0) {
+        config.access = EAccessMethod::kReader;
+      } else if (strcmp(optarg, "direct") == 0) {
+        config.access = EAccessMethod::kDirect;
+      } else if (strcmp(optarg, "rdf") != 0) {
+        std::cerr << "ERROR: Unknown access method " << optarg << std::endl;
+        return 1;
+      }
+      break;
+    case 'k':
+      if (strcmp(optarg, "sum") == 0) {
+        config.kernel = EKernel::kSum;
+      } else if (strcmp(optarg, "histo") != 0) {
+        std::cerr << "ERROR: Unknown kernel " << optarg << std::endl;
+        return 1;
+      }
+      break;
+    case 'p':
+      config.profileColumns = true;
+      break;
+    case 'I':
+      ioStrategyList = optarg;
+      break;
+    case 'm':
+      config.medium = optarg;
+      break;
+    case 'o':
+      if (!parseOutputFormat(optarg, config.outputFormat)) {
+        std::cerr << "ERROR: Unknown output format " << optarg << std::endl;
+        return 1;
+      }
+      break;
     default:
       printUsage(argv[0]);
       return 1;
     }
   }
 
-  if (inputPath == "") {
+  // Overrides the fraction from the workload file, to easily scan over fractions of the same set of
+  // columns.
+  if (fraction > 0.)
+    workload.fraction = fraction;
+
+  if (config.inputPaths.empty()) {
     std::cerr << "ERROR: please provide an input path\n" << std::endl;
     printUsage(argv[0]);
     return 1;
   }
 
-  if (storeName == "") {
+  if (config.storeName == "") {
     std::cerr << "ERROR: please provide the name of the TTree/RNTuple to read\n" << std::endl;
     printUsage(argv[0]);
     return 1;
   }
 
+  // The I/O strategies depend on the format, which may be given after them.
+  std::vector<IOStrategy> ioStrategies;
+  std::stringstream ioStrategyStream(ioStrategyList);
+  std::string ioStrategySpec;
+  while (std::getline(ioStrategyStream, ioStrategySpec, ',')) {
+    IOStrategy strategy;
+    if (!parseIOStrategy(ioStrategySpec, config.isRNTuple, strategy)) {
+      std::cerr << "ERROR: invalid I/O strategy " << ioStrategySpec << " for "
+                << (config.isRNTuple ? "RNTuple" : "TTree") << std::endl;
+      return 1;
+    }
+    ioStrategies.emplace_back(strategy);
+  }
+  const bool compareIOStrategies = !ioStrategies.empty();
+  if (!compareIOStrategies)
+    ioStrategies.emplace_back();
+
+  if (compareIOStrategies && (config.inputPaths.size() > 1 || config.profileColumns)) {
+    std::cerr << "ERROR: I/O strategies can only be compared for a single input file, and not "
+                 "with the per-column profile"
+              << std::endl;
+    return 1;
+  }
+
   auto verbosity = ROOT::Experimental::RLogScopedVerbosity(ROOT::Detail::RDF::RDFLogChannel(),
                                                            ROOT::Experimental::ELogLevel::kInfo);
 
-  if (isRNTuple) {
-    ROOT::RDataFrame rdf = ROOT::RDF::Experimental::FromRNTuple(storeName, inputPath);
-    bmRDFReadspeed(rdf, isRNTuple);
+  // The histograms filled when reading through the native interfaces are not written anywhere.
+  TH1::AddDirectory(false);
+
+  config.columnNames =
+      getColumnNames(workload, config.inputPaths[0], config.storeName, config.isRNTuple);
+  config.filter = getFilterExpression(workload, config.isRNTuple);
+
+  if (config.columnNames.empty()) {
+    std::cerr << "ERROR: no columns match the workload" << std::endl;
+    return 1;
+  }
+
+  // The columns are taken from the first input file, so with the native interfaces, which read
+  // each file separately, they are checked in every file.
+  if (config.access != EAccessMethod::kRDF) {
+    bool hasInvalidColumns = false;
+    for (const auto &inputPath : config.inputPaths) {
+      auto rdf = openDataFrame(inputPath, config.storeName, config.isRNTuple);
+      for (const auto &col : config.columnNames) {
+        if (!rdf->HasColumn(col)) {
+          std::cerr << "ERROR: column " << col << " is missing in " << inputPath << std::endl;
+          hasInvalidColumns = true;
+          continue;
+        }
+        // The members of a collection with a shared offset column are single floats, which are
+        // only read through their collection.
+        if (config.isRNTuple && config.access == EAccessMethod::kReader &&
+            col.find('.') != std::string::npos) {
+          std::cerr << "ERROR: column " << col << " is a member of a collection, which can only "
+                    << "be read with -a direct or -a rdf" << std::endl;
+          hasInvalidColumns = true;
+          continue;
+        }
+        const auto colType = rdf->GetColumnType(col);
+        if (!isFloatVectorType(colType)) {
+          std::cerr << "ERROR: column " << col << " has type " << colType << " in " << inputPath
+                    << ", but only std::vector<float> columns can be read with -a "
+                    << getAccessMethodName(config.access) << std::endl;
+          hasInvalidColumns = true;
+        }
+      }
+    }
+    if (hasInvalidColumns)
+      return 1;
+  }
+
+  if (config.access != EAccessMethod::kRDF && !config.filter.empty()) {
+    std::cerr << "WARNING: the workload filter is ignored when not reading through RDataFrame"
+              << std::endl;
+  }
+
+  config.columnBytes =
+      getColumnBytes(config.columnNames, config.inputPaths, config.storeName, config.isRNTuple);
+  config.compression =
+      getCompressionSettings(config.inputPaths[0], config.storeName, config.isRNTuple);
+
+  // Reject the TTree I/O strategies that would not have any effect, so they are not reported as
+  // if they had been applied.
+  if (!config.isRNTuple) {
+    const bool hasMTRun = std::any_of(threadCounts.begin(), threadCounts.end(),
+                                      [](unsigned nThreads) { return nThreads > 1; });
+    const bool hasSerialRun = std::any_of(threadCounts.begin(), threadCounts.end(),
+                                          [](unsigned nThreads) { return nThreads == 1; });
+    for (const auto &ioStrategy : ioStrategies) {
+      if (ioStrategy.name == "default")
+        continue;
+      if (config.access == EAccessMethod::kRDF && hasMTRun) {
+        std::cerr << "ERROR: with multiple threads, RDataFrame opens its own trees, so the I/O "
+                     "strategy "
+                  << ioStrategy.name << " cannot be applied" << std::endl;
+        return 1;
+      }
+      if (ioStrategy.parallelUnzip && hasSerialRun) {
+        std::cerr << "ERROR: the I/O strategy " << ioStrategy.name
+                  << " requires more than one thread, since the baskets are only decompressed in "
+                     "parallel with implicit multi-threading"
+                  << std::endl;
+        return 1;
+      }
+      if (ioStrategy.parallelUnzip && config.compression % 100 == 0) {
+        std::cerr << "ERROR: the I/O strategy " << ioStrategy.name
+                  << " has no effect on an uncompressed file" << std::endl;
+        return 1;
+      }
+    }
+  }
+
+  if (config.profileColumns) {
+    if (config.inputPaths.size() > 1) {
+      std::cerr << "ERROR: the per-column profile is only available for a single input file"
+                << std::endl;
+      return 1;
+    }
+
+    const auto costs = runColumnProfile(config);
+    if (config.outputFormat == EOutputFormat::kText)
+      printColumnProfile(costs);
+    else
+      writeRecords(std::cout, getColumnProfileRecords(config, costs), config.outputFormat);
+    return 0;
+  }
+
+  const auto openResults = runOpenBenchmark(config);
+
+  // All thread counts are run for each I/O strategy.
+  std::vector<ReadspeedResult> results;
+  try {
+    for (const auto &ioStrategy : ioStrategies) {
+      config.ioStrategy = ioStrategy;
+      for (const auto nThreads : threadCounts) {
+        results.emplace_back(runReadspeed(config, nThreads));
+      }
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "ERROR: " << e.what() << std::endl;
+    return 1;
+  }
+
+  if (config.outputFormat == EOutputFormat::kText) {
+    std::cout << "Columns read: " << config.columnNames.size() << std::endl;
+    if (compareIOStrategies) {
+      for (const auto &ioStrategy : ioStrategies) {
+        std::vector<ReadspeedResult> strategyResults;
+        std::copy_if(results.begin(), results.end(), std::back_inserter(strategyResults),
+                     [&ioStrategy](const auto &r) { return r.ioStrategy == ioStrategy.name; });
+        std::cout << "I/O strategy: " << ioStrategy.name << std::endl;
+        printRepetitionStats(strategyResults);
+        printScalingResults(strategyResults, config.columnBytes);
+      }
+      printOpenStats(openResults);
+      printIOStrategyComparison(config, results);
+    } else {
+      printRepetitionStats(results);
+      printOpenStats(openResults);
+      printScalingResults(results, config.columnBytes);
+    }
   } else {
-    auto file = TFile::Open(inputPath.c_str());
-    auto tree = file->Get<TTree>(storeName.c_str());
-    auto treeStats = new TTreePerfStats("ioperf", tree);
-    ROOT::RDataFrame rdf(*tree);
-    bmRDFReadspeed(rdf, isRNTuple);
-    treeStats->Print();
+    writeRecords(std::cout, getRecords(config, results, openResults), config.outputFormat);
   }
 
   return 0;
@@ -0,0 +1,620 @@
+#include <ROOT/REntry.hxx>
+#include <ROOT/RField.hxx>
+#include <ROOT/RNTupleInspector.hxx>
+#include <ROOT/RNTupleModel.hxx>
+#include <ROOT/RNTupleOptions.hxx>
+#include <ROOT/RNTupleReader.hxx>
+#include <ROOT/RNTupleWriter.hxx>
+
+#include <RVersion.h>
+#include <TROOT.h>
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bm-utils/bm_options.hxx"
+#include "bm-utils/bm_output.hxx"
+
+using ROOT::Experimental::EColumnType;
+using ROOT::Experimental::RField;
+using ROOT::Experimental::RFieldBase;
+using ROOT::Experimental::RNTupleInspector;
+using ROOT::Experimental::RNTupleModel;
+using ROOT::Experimental::RNTupleReader;
+using ROOT::Experimental::RNTupleView;
+using ROOT::Experimental::RNTupleWriteOptions;
+using ROOT::Experimental::RNTupleWriter;
+
+// Study of the on-disk column representations of the `std::vector<float>` fields of an RNTuple.
+// The selected fields are rewritten once per encoding, with the same compression settings, after
+// which the size of their value columns, the throughput of reading them back (decompression and
+// decoding, from the page cache) and the numeric error with respect to the original values are
+// measured. The truncated and quantized encodings require ROOT 6.34:
+//   split    -- 32-bit floats, byte-split before compression (the default of RNTuple)
+//   unsplit  -- 32-bit floats, stored as is
+//   half     -- 16-bit IEEE half precision floats
+//   truncN   -- 32-bit floats with only the N most significant bits stored, 10 <= N <= 31
+//   quantN   -- N-bit integers, 1 <= N <= 32, spread evenly over the [min, max] range of the
+//               values of the field in the input
+
+enum class EEncoding { kSplit, kUnsplit, kHalf, kTruncated, kQuantized };
+
+struct Encoding {
+  std::string name;
+  EEncoding type;
+  unsigned nBits = 32;
+};
+
+struct EncodingConfig {
+  std::string inputPath;
+  std::string ntupleName = "CollectionTree";
+  std::string outputDir = ".";
+  std::regex fieldRegex{".*"};
+  std::vector<Encoding> encodings;
+  int compression = -1;
+  unsigned nRepetitions = 3;
+  bool keepOutput = false;
+  EOutputFormat outputFormat = EOutputFormat::kText;
+};
+
+// Running minimum, maximum, mean and standard deviation of a column, to compare the distribution
+// of the encoded values with that of the original ones. Non-finite values (infinities and NaNs) are
+// only counted.
+struct ValueStats {
+  std::uint64_t n = 0; // finite values
+  std::uint64_t nNonFinite = 0;
+  double min = std::numeric_limits<double>::max();
+  double max = std::numeric_limits<double>::lowest();
+  double sum = 0.;
+  double sumSquares = 0.;
+
+  void add(double v) {
+    if (!std::isfinite(v)) {
+      ++nNonFinite;
+      return;
+    }
+    ++n;
+    min = std::min(min, v);
+    max = std::max(max, v);
+    sum += v;
+    sumSquares += v * v;
+  }
+  double getMean() const { return n ? sum / n : 0.; }
+  double getStdDev() const {
+    return n ? std::sqrt(std::max(0., sumSquares / n - getMean() * getMean())) : 0.;
+  }
+};
+
+// The relative error is only computed for non-zero original values. Non-finite original values
+// are skipped, since their error is not defined.
+struct ErrorStats {
+  double maxAbsError = 0.;
+  double sumAbsError = 0.;
+  double maxRelError = 0.;
+  double sumRelError = 0.;
+  std::uint64_t nRelValues = 0;
+
+  void add(double original, double encoded) {
+    if (!std::isfinite(original))
+      return;
+    const double absError = std::abs(encoded - original);
+    maxAbsError = std::max(maxAbsError, absError);
+    sumAbsError += absError;
+    if (original != 0.) {
+      const double relError = absError / std::abs(original);
+      maxRelError = std::max(maxRelError, relError);
+      sumRelError += relError;
+      ++nRelValues;
+    }
+  }
+  double getMeanRelError() const { return nRelValues ? sumRelError / nRelValues : 0.; }
+};
+
+struct FieldResult {
+  std::string fieldName;
+  std::uint64_t onDiskSize = 0;   // of the value column, in bytes
+  std::uint64_t inMemorySize = 0; // of the value column after decompression, in bytes
+  ValueStats encodedStats;
+  ErrorStats errorStats;
+};
+
+struct EncodingResult {
+  const Encoding *encoding;
+  std::vector<FieldResult> fields;
+  std::uint64_t nEntries = 0;
+  std::uint64_t nValues = 0;
+  std::uint64_t onDiskSize = 0;
+  std::uint64_t inMemorySize = 0;
+  double readTime = 0.; // median over the repetitions, in seconds
+};
+
+bool parseEncodings(const std::string &arg, std::vector<Encoding> &encodings) {
+  static const std::regex bitsRegex(R"((trunc|quant)(\d+))");
+
+  std::istringstream ss(arg);
+  std::string name;
+  while (std::getline(ss, name, ',')) {
+    std::smatch match;
+    if (name == "split") {
+      encodings.emplace_back(Encoding{name, EEncoding::kSplit});
+    } else if (name == "unsplit") {
+      encodings.emplace_back(Encoding{name, EEncoding::kUnsplit});
+    } else if (name == "half") {
+      encodings.emplace_back(Encoding{name, EEncoding::kHalf, 16});
+    } else if (std::regex_match(name, match, bitsRegex)) {
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6, 34, 0)
+      const bool isTruncated = match[1] == "trunc";
+      const unsigned nBits = std::stoul(match[2]);
+      if (isTruncated ? (nBits < 10 || nBits > 31) : (nBits < 1 || nBits > 32)) {
+        std::cerr << "ERROR: invalid number of bits for encoding " << name << std::endl;
+        return false;
+      }
+      encodings.emplace_back(
+          Encoding{name, isTruncated ? EEncoding::kTruncated : EEncoding::kQuantized, nBits});
+#else
+      std::cerr << "ERROR: truncated and quantized floats require ROOT 6.34 or newer" << std::endl;
+      return false;
+#endif
+    } else {
+      std::cerr << "ERROR: unknown encoding " << name << std::endl;
+      return false;
+    }
+  }
+
+  return !encodings.empty();
+}
+
+std::string getDefaultEncodings() {
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6, 34, 0)
+  return "split,unsplit,half,trunc20,trunc16,quant16,quant12";
+#else
+  return "split,unsplit,half";
+#endif
+}
+
+std::vector<std::string> getFloatVectorFields(const EncodingConfig &config) {
+  auto reader = RNTupleReader::Open(config.ntupleName, config.inputPath);
+
+  std::vector<std::string> fieldNames;
+  for (const auto &fld : reader->GetDescriptor()->GetTopLevelFields()) {
+    if (fld.GetTypeName() == "std::vector<float>" &&
+        std::regex_match(fld.GetFieldName(), config.fieldRegex)) {
+      fieldNames.emplace_back(fld.GetFieldName());
+    }
+  }
+  return fieldNames;
+}
+
+// Reads the statistics of the original values of every field, which also provide the range for
+// the quantized encodings.
+std::vector<ValueStats> getOriginalStats(const EncodingConfig &config,
+                                         const std::vector<std::string> &fieldNames) {
+  auto reader = RNTupleReader::Open(config.ntupleName, config.inputPath);
+
+  std::vector<ValueStats> stats(fieldNames.size());
+  for (std::size_t f = 0; f < fieldNames.size(); ++f) {
+    auto view = reader->GetView<std::vector<float>>(fieldNames[f]);
+    for (auto i : reader->GetEntryRange()) {
+      for (const auto v : view(i))
+        stats[f].add(v);
+    }
+  }
+  return stats;
+}
+
+// The range of the quantized encodings is that of the original values. ROOT requires a non-empty
+// range, so it is widened for fields without values or with a single distinct value.
+std::pair<double, double> getQuantizationRange(const ValueStats &originalStats) {
+  if (originalStats.n == 0)
+    return {0., 1.};
+  if (originalStats.min < originalStats.max)
+    return {originalStats.min, originalStats.max};
+  return {originalStats.min, std::nextafter(static_cast<float>(originalStats.min),
+                                            std::numeric_limits<float>::infinity())};
+}
+
+std::unique_ptr<RFieldBase> createField(const std::string &fieldName, const Encoding &encoding,
+                                        const ValueStats &originalStats) {
+  auto field = std::make_unique<RField<std::vector<float>>>(fieldName);
+  auto itemField = dynamic_cast<RField<float> *>(field->GetSubFields()[0]);
+
+  switch (encoding.type) {
+  case EEncoding::kSplit:
+    break;
+  case EEncoding::kUnsplit:
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6, 34, 0)
+    itemField->SetColumnRepresentatives({{EColumnType::kReal32}});
+#else
+    itemField->SetColumnRepresentative({EColumnType::kReal32});
+#endif
+    break;
+  case EEncoding::kHalf:
+    itemField->SetHalfPrecision();
+    break;
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6, 34, 0)
+  case EEncoding::kTruncated:
+    itemField->SetTruncated(encoding.nBits);
+    break;
+  case EEncoding::kQuantized: {
+    const auto [min, max] = getQuantizationRange(originalStats);
+    itemField->SetQuantized(min, max, encoding.nBits);
+    break;
+  }
+#endif
+  default:
+    break;
+  }
+
+  return field;
+}
+
+std::string getOutputPath(const EncodingConfig &config, const Encoding &encoding,
+                          int compression) {
+  return config.outputDir + "/float_encoding." + encoding.name + ".root~" +
+         std::to_string(compression);
+}
+
+void writeEncoding(const EncodingConfig &config, const std::vector<std::string> &fieldNames,
+                   const std::vector<ValueStats> &originalStats, const Encoding &encoding,
+                   const std::string &outputPath, int compression) {
+  auto reader = RNTupleReader::Open(config.ntupleName, config.inputPath);
+
+  auto model = RNTupleModel::CreateBare();
+  for (std::size_t f = 0; f < fieldNames.size(); ++f) {
+    model->AddField(createField(fieldNames[f], encoding, originalStats[f]));
+  }
+
+  RNTupleWriteOptions writeOptions;
+  writeOptions.SetCompression(compression);
+  auto writer =
+      RNTupleWriter::Recreate(std::move(model), config.ntupleName, outputPath, writeOptions);
+  auto entry = writer->CreateEntry();
+
+  std::vector<RNTupleView<std::vector<float>>> views;
+  std::vector<std::shared_ptr<std::vector<float>>> values;
+  for (const auto &fieldName : fieldNames) {
+    views.emplace_back(reader->GetView<std::vector<float>>(fieldName));
+    values.emplace_back(std::make_shared<std::vector<float>>());
+    entry->BindValue(fieldName, values.back());
+  }
+
+  for (auto i : reader->GetEntryRange()) {
+    for (std::size_t f = 0; f < views.size(); ++f) {
+      *values[f] = views[f](i);
+    }
+    writer->Fill(*entry);
+  }
+}
+
+// Reads all values of the encoded fields, which includes decompressing and decoding their pages.
+double readEncoding(const EncodingConfig &config, const std::vector<std::string> &fieldNames,
+                    const std::string &outputPath) {
+  const auto start = std::chrono::steady_clock::now();
+
+  auto reader = RNTupleReader::Open(config.ntupleName, outputPath);
+  std::vector<RNTupleView<std::vector<float>>> views;
+  for (const auto &fieldName : fieldNames) {
+    views.emplace_back(reader->GetView<std::vector<float>>(fieldName));
+  }
+
+  double sum = 0.;
+  for (auto i : reader->GetEntryRange()) {
+    for (auto &view : views) {
+      for (const auto v : view(i))
+        sum += v;
+    }
+  }
+
+  const double wallTime =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  // Make sure the values are not optimized away.
+  if (std::isnan(sum))
+    std::cerr << "WARNING: sum of the values of " << outputPath << " is NaN" << std::endl;
+
+  return wallTime;
+}
+
+// Compares the encoded values with the original ones, entry by entry.
+void compareEncoding(const EncodingConfig &config, const std::string &outputPath,
+                     EncodingResult &result) {
+  auto originalReader = RNTupleReader::Open(config.ntupleName, config.inputPath);
+  auto encodedReader = RNTupleReader::Open(config.ntupleName, outputPath);
+  result.nEntries = encodedReader->GetNEntries();
+
+  for (auto &field : result.fields) {
+    auto originalView = originalReader->GetView<std::vector<float>>(field.fieldName);
+    auto encodedView = encodedReader->GetView<std::vector<float>>(field.fieldName);
+
+    for (auto i : encodedReader->GetEntryRange()) {
+      const auto &original = originalView(i);
+      const auto &encoded = encodedView(i);
+      for (std::size_t j = 0; j < encoded.size(); ++j) {
+        field.encodedStats.add(encoded[j]);
+        field.errorStats.add(original[j], encoded[j]);
+      }
+    }
+    result.nValues += field.encodedStats.n + field.encodedStats.nNonFinite;
+  }
+}
+
+// Only the size of the value (item) columns is counted, as the offset columns of the fields are
+// the same for all encodings.
+void measureSize(const EncodingConfig &config, const std::string &outputPath,
+                 EncodingResult &result) {
+  auto inspector = RNTupleInspector::Create(config.ntupleName, outputPath);
+  const auto descriptor = inspector->GetDescriptor();
+
+  for (auto &field : result.fields) {
+    const auto fieldId = descriptor->FindFieldId(field.fieldName);
+    const auto itemFieldId = descriptor->GetFieldDescriptor(fieldId).GetLinkIds()[0];
+    const auto info = inspector->GetFieldTreeInfo(itemFieldId);
+    field.onDiskSize = info.GetOnDiskSize();
+    field.inMemorySize = info.GetInMemorySize();
+    result.onDiskSize += field.onDiskSize;
+    result.inMemorySize += field.inMemorySize;
+  }
+}
+
+EncodingResult runEncoding(const EncodingConfig &config,
+                           const std::vector<std::string> &fieldNames,
+                           const std::vector<ValueStats> &originalStats, const Encoding &encoding,
+                           int compression) {
+  EncodingResult result{&encoding, {}};
+  for (const auto &fieldName : fieldNames) {
+    result.fields.emplace_back(FieldResult{fieldName});
+  }
+
+  const auto outputPath = getOutputPath(config, encoding, compression);
+  writeEncoding(config, fieldNames, originalStats, encoding, outputPath, compression);
+  measureSize(config, outputPath, result);
+
+  std::vector<double> readTimes;
+  for (unsigned r = 0; r < config.nRepetitions; ++r) {
+    readTimes.emplace_back(readEncoding(config, fieldNames, outputPath));
+  }
+  std::sort(readTimes.begin(), readTimes.end());
+  const auto n = readTimes.size();
+  result.readTime = n % 2 ? readTimes[n / 2] : (readTimes[n / 2 - 1] + readTimes[n / 2]) / 2.;
+
+  compareEncoding(config, outputPath, result);
+
+  if (!config.keepOutput)
+    std::filesystem::remove(outputPath);
+
+  return result;
+}
+
+double getMaxRelError(const EncodingResult &result) {
+  double maxRelError = 0.;
+  for (const auto &field : result.fields) {
+    maxRelError = std::max(maxRelError, field.errorStats.maxRelError);
+  }
+  return maxRelError;
+}
+
+double getMeanRelError(const EncodingResult &result) {
+  double sumRelError = 0.;
+  std::uint64_t nRelValues = 0;
+  for (const auto &field : result.fields) {
+    sumRelError += field.errorStats.sumRelError;
+    nRelValues += field.errorStats.nRelValues;
+  }
+  return nRelValues ? sumRelError / nRelValues : 0.;
+}
+
+// The size ratio is given with respect to the first encoding.
+void printResults(const std::vector<EncodingResult> &results) {
+  std::cout << "encoding\tcompressed_mb\tsize_ratio\tbits_per_value\tentries_per_s\t"
+               "decoded_mb_per_s\tmax_rel_error\tmean_rel_error"
+            << std::endl;
+  for (const auto &result : results) {
+    const double nValues = std::max<std::uint64_t>(result.nValues, 1);
+    std::cout << result.encoding->name << "\t" << result.onDiskSize / 1e6 << "\t"
+              << static_cast<double>(result.onDiskSize) / results[0].onDiskSize << "\t"
+              << result.onDiskSize * 8. / nValues << "\t" << result.nEntries / result.readTime
+              << "\t" << result.nValues * sizeof(float) / 1e6 / result.readTime << "\t"
+              << getMaxRelError(result) << "\t" << getMeanRelError(result) << std::endl;
+  }
+}
+
+std::vector<MetricsRecord_t> getRecords(const EncodingConfig &config,
+                                        const std::vector<EncodingResult> &results,
+                                        const std::vector<ValueStats> &originalStats,
+                                        int compression) {
+  std::vector<MetricsRecord_t> records;
+
+  for (const auto &result : results) {
+    MetricsRecord_t record;
+    addMetric(record, "record", "encoding");
+    addMetric(record, "file", config.inputPath);
+    addMetric(record, "compression", compression);
+    addMetric(record, "encoding", result.encoding->name);
+    addMetric(record, "fields", result.fields.size());
+    addMetric(record, "entries", result.nEntries);
+    addMetric(record, "values", result.nValues);
+    addMetric(record, "compressed_bytes", result.onDiskSize);
+    addMetric(record, "uncompressed_bytes", result.inMemorySize);
+    addMetric(record, "size_ratio", static_cast<double>(result.onDiskSize) / results[0].onDiskSize);
+    addMetric(record, "read_time_s", result.readTime);
+    addMetric(record, "entries_per_s", result.nEntries / result.readTime);
+    addMetric(record, "decoded_mb_per_s", result.nValues * sizeof(float) / 1e6 / result.readTime);
+    addMetric(record, "compressed_mb_per_s", result.onDiskSize / 1e6 / result.readTime);
+    addMetric(record, "max_rel_error", getMaxRelError(result));
+    addMetric(record, "mean_rel_error", getMeanRelError(result));
+    records.emplace_back(std::move(record));
+  }
+
+  for (const auto &result : results) {
+    for (std::size_t f = 0; f < result.fields.size(); ++f) {
+      const auto &field = result.fields[f];
+      MetricsRecord_t record;
+      addMetric(record, "record", "field");
+      addMetric(record, "file", config.inputPath);
+      addMetric(record, "compression", compression);
+      addMetric(record, "encoding", result.encoding->name);
+      addMetric(record, "field", field.fieldName);
+      addMetric(record, "values", field.encodedStats.n + field.encodedStats.nNonFinite);
+      addMetric(record, "compressed_bytes", field.onDiskSize);
+      addMetric(record, "uncompressed_bytes", field.inMemorySize);
+      addMetric(record, "max_abs_error", field.errorStats.maxAbsError);
+      addMetric(record, "mean_abs_error",
+                field.encodedStats.n ? field.errorStats.sumAbsError / field.encodedStats.n : 0.);
+      addMetric(record, "max_rel_error", field.errorStats.maxRelError);
+      addMetric(record, "mean_rel_error", field.errorStats.getMeanRelError());
+      addMetric(record, "original_non_finite", originalStats[f].nNonFinite);
+      addMetric(record, "encoded_non_finite", field.encodedStats.nNonFinite);
+      addMetric(record, "original_min", originalStats[f].min);
+      addMetric(record, "original_max", originalStats[f].max);
+      addMetric(record, "original_mean", originalStats[f].getMean());
+      addMetric(record, "original_stdev", originalStats[f].getStdDev());
+      addMetric(record, "encoded_min", field.encodedStats.min);
+      addMetric(record, "encoded_max", field.encodedStats.max);
+      addMetric(record, "encoded_mean", field.encodedStats.getMean());
+      addMetric(record, "encoded_stdev", field.encodedStats.getStdDev());
+      records.emplace_back(std::move(record));
+    }
+  }
+
+  return records;
+}
+
+static void printUsage(std::string_view prog) {
+  std::cout << "USAGE: " << prog
+            << " (-h|-i INPUT_PATH [-n NTUPLE_NAME] [-x FIELD_REGEX] [-e ENCODING[,ENCODING...]] "
+               "[-d OUTPUT_DIR] [-c COMPRESSION] [-r N_REPETITIONS] [-k] [-o (text|json|csv)])"
+            << std::endl;
+  std::cout << "ENCODING: split, unsplit, half, truncN (10 <= N <= 31) or quantN (1 <= N <= 32)"
+            << std::endl;
+}
+
+int main(int argc, char **argv) {
+  // Suppress (irrelevant) warnings
+  gErrorIgnoreLevel = kError;
+
+  EncodingConfig config;
+  std::string encodingsArg = getDefaultEncodings();
+
+  int c;
+  while ((c = getopt(argc, argv, "hi:n:x:e:d:c:r:ko:")) != -1) {
+    switch (c) {
+    case 'h':
+      printUsage(argv[0]);
+      return 0;
+    case 'i':
+      config.inputPath = optarg;
+      break;
+    case 'n':
+      config.ntupleName = optarg;
+      break;
+    case 'x':
+      config.fieldRegex = std::regex(optarg);
+      break;
+    case 'e':
+      encodingsArg = optarg;
+      break;
+    case 'd':
+      config.outputDir = optarg;
+      break;
+    case 'c':
+      if (!parseCompression(optarg, config.compression)) {
+        std::cerr << "ERROR: invalid compression setting " << optarg << std::endl;
+        return 1;
+      }
+      break;
+    case 'r':
+      if (!parseUnsigned(optarg, config.nRepetitions)) {
+        std::cerr << "ERROR: invalid number of repetitions " << optarg << std::endl;
+        return 1;
+      }
+      if (config.nRepetitions < 1) {
+        std::cerr << "ERROR: the number of repetitions must be at least 1" << std::endl;
+        return 1;
+      }
+      break;
+    case 'k':
+      config.keepOutput = true;
+      break;
+    case 'o':
+      if (!parseOutputFormat(optarg, config.outputFormat)) {
+        std::cerr << "ERROR: Unknown output format " << optarg << std::endl;
+        return 1;
+      }
+      break;
+    default:
+      printUsage(argv[0]);
+      return 1;
+    }
+  }
+
+  if (config.inputPath.empty()) {
+    std::cerr << "ERROR: please provide an input path\n" << std::endl;
+    printUsage(argv[0]);
+    return 1;
+  }
+
+  if (!parseEncodings(encodingsArg, config.encodings)) {
+    printUsage(argv[0]);
+    return 1;
+  }
+
+  // By default, use the same compression settings as the input.
+  const int compression =
+      config.compression >= 0
+          ? config.compression
+          : RNTupleInspector::Create(config.ntupleName, config.inputPath)->GetCompressionSettings();
+
+  auto fieldNames = getFloatVectorFields(config);
+  if (fieldNames.empty()) {
+    std::cerr << "ERROR: no std::vector<float> fields found" << std::endl;
+    return 1;
+  }
+  auto originalStats = getOriginalStats(config, fieldNames);
+
+  // Infinities and NaNs cannot be quantized, so fields containing them are excluded from the study
+  // when a quantized encoding is requested, to compare all encodings on the same fields.
+  const bool hasQuantized =
+      std::any_of(config.encodings.begin(), config.encodings.end(),
+                  [](const Encoding &encoding) { return encoding.type == EEncoding::kQuantized; });
+  if (hasQuantized) {
+    for (std::size_t f = fieldNames.size(); f-- > 0;) {
+      if (originalStats[f].nNonFinite == 0)
+        continue;
+      std::cerr << "WARNING: excluding field " << fieldNames[f] << ", which contains "
+                << originalStats[f].nNonFinite << " non-finite values that cannot be quantized"
+                << std::endl;
+      fieldNames.erase(fieldNames.begin() + f);
+      originalStats.erase(originalStats.begin() + f);
+    }
+    if (fieldNames.empty()) {
+      std::cerr << "ERROR: no fields left to quantize" << std::endl;
+      return 1;
+    }
+  }
+
+  std::filesystem::create_directories(config.outputDir);
+  std::vector<EncodingResult> results;
+  for (const auto &encoding : config.encodings) {
+    results.emplace_back(runEncoding(config, fieldNames, originalStats, encoding, compression));
+  }
+
+  if (config.outputFormat == EOutputFormat::kText)
+    printResults(results);
+  else
+    writeRecords(std::cout, getRecords(config, results, originalStats, compression),
+                 config.outputFormat);
+
+  return 0;
+}
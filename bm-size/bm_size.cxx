@@ -7,34 +7,79 @@
 #include <iostream>
 #include <vector>
 
+#include "bm-utils/bm_memory.hxx"
+#include "bm-utils/bm_ntuple_compat.hxx"
+#include "bm-utils/bm_output.hxx"
+
 using ROOT::Experimental::RNTuple;
 using ROOT::Experimental::RNTupleInspector;
 
-void bmNTupleSize(const std::string ntuplePath, const std::string ntupleName) {
+MetricsRecord_t bmNTupleSize(const std::string ntuplePath, const std::string ntupleName) {
   auto file = std::unique_ptr<TFile>(TFile::Open(ntuplePath.c_str()));
   auto ntuple = file->Get<RNTuple>(ntupleName.c_str());
   auto inspector = RNTupleInspector::Create(ntuple);
   auto descriptor = inspector->GetDescriptor();
 
-  std::cout << "rntuple\t" << inspector->GetCompressionSettings() << "\t"
-            << descriptor->GetNEntries() << "\t" << descriptor->GetNFields() << "\t"
-            << inspector->GetCompressedSize() << "\t" << inspector->GetUncompressedSize() << std::endl;
+  MetricsRecord_t record;
+  addMetric(record, "format", "rntuple");
+  addMetric(record, "compression", inspector->GetCompressionSettings());
+  addMetric(record, "entries", descriptor->GetNEntries());
+  addMetric(record, "columns", descriptor->GetNFields());
+  addMetric(record, "compressed_bytes", inspector->GetCompressedSize());
+  addMetric(record, "uncompressed_bytes", inspector->GetUncompressedSize());
+  return record;
 }
 
-void bmTreeSize(const std::string treePath, const std::string treeName) {
+MetricsRecord_t bmTreeSize(const std::string treePath, const std::string treeName) {
   std::unique_ptr<TFile> file;
 
   file = std::unique_ptr<TFile>(TFile::Open(treePath.c_str()));
 
   auto tree = file->Get<TTree>(treeName.c_str());
 
-  std::cout << "ttree\t" << file->GetCompressionSettings() << "\t" << tree->GetEntries() << "\t"
-            << tree->GetNbranches() << "\t" << tree->GetZipBytes() << "\t" << tree->GetTotBytes()
-            << std::endl;
+  MetricsRecord_t record;
+  addMetric(record, "format", "ttree");
+  addMetric(record, "compression", file->GetCompressionSettings());
+  addMetric(record, "entries", tree->GetEntries());
+  addMetric(record, "columns", tree->GetNbranches());
+  addMetric(record, "compressed_bytes", tree->GetZipBytes());
+  addMetric(record, "uncompressed_bytes", tree->GetTotBytes());
+  return record;
+}
+
+// Memory needed to open the file and load the metadata required to start reading, i.e. the TTree
+// (including the basket index) or the RNTuple header and footer. This is done before measuring the
+// size, so the peak RSS is not affected by the (larger) metadata kept by the RNTuple inspector.
+void addOpenMemory(MetricsRecord_t &record, const std::string &inputPath,
+                   const std::string &storeName, bool isRNTuple) {
+  resetPeakRSS();
+  const long rssBefore = getCurrentRSS();
+  resetAllocationStats();
+
+  if (isRNTuple) {
+    auto pageSource = RPageSource::Create(storeName, inputPath);
+    pageSource->Attach();
+  } else {
+    auto file = std::unique_ptr<TFile>(TFile::Open(inputPath.c_str()));
+    auto tree = file->Get<TTree>(storeName.c_str());
+    tree->GetEntries();
+  }
+
+  const auto allocations = getAllocationStats();
+  addMetric(record, "open_rss_before_kb", rssBefore);
+  addMetric(record, "open_peak_rss_kb", getPeakRSS());
+  if (kCountAllocations) {
+    addMetric(record, "open_allocations", allocations.nAllocations);
+    addMetric(record, "open_allocated_bytes", allocations.allocatedBytes);
+    addMetric(record, "open_peak_heap_bytes", allocations.peakBytes);
+  }
 }
 
 static void printUsage(std::string_view prog) {
-  std::cout << "USAGE: " << prog << " (-h|-i INPUT_PATH -s (ttree|rntuple) [-n STORE_NAME])" << std::endl;
+  std::cout << "USAGE: " << prog
+            << " (-h|-i INPUT_PATH -s (ttree|rntuple) [-n STORE_NAME] [-m MEDIUM] "
+               "[-o (text|json|csv)])"
+            << std::endl;
 }
 
 int main(int argc, char **argv) {
@@ -43,10 +88,12 @@ int main(int argc, char **argv) {
 
   std::string inputPath;
   std::string storeName = "CollectionTree";
+  std::string medium = "unknown";
   bool isRNTuple = false;
+  EOutputFormat outputFormat = EOutputFormat::kText;
 
   int c;
-  while ((c = getopt(argc, argv, "hi:n:s:")) != -1) {
+  while ((c = getopt(argc, argv, "hi:n:s:m:o:")) != -1) {
     switch (c) {
     case 'h':
       printUsage(argv[0]);
@@ -65,6 +112,15 @@ int main(int argc, char **argv) {
         return 1;
       }
       break;
+    case 'm':
+      medium = optarg;
+      break;
+    case 'o':
+      if (!parseOutputFormat(optarg, outputFormat)) {
+        std::cerr << "ERROR: Unknown output format " << optarg << std::endl;
+        return 1;
+      }
+      break;
     default:
       printUsage(argv[0]);
       return 1;
@@ -83,10 +139,30 @@ int main(int argc, char **argv) {
     return 1;
   }
 
-  if (isRNTuple) {
-    bmNTupleSize(inputPath, storeName);
+  // The text output is read by plot_size.C, so the memory usage is only part of the JSON and CSV
+  // output.
+  MetricsRecord_t memoryRecord;
+  if (outputFormat != EOutputFormat::kText)
+    addOpenMemory(memoryRecord, inputPath, storeName, isRNTuple);
+
+  auto record = isRNTuple ? bmNTupleSize(inputPath, storeName) : bmTreeSize(inputPath, storeName);
+
+  if (outputFormat == EOutputFormat::kText) {
+    // FORMAT COMPRESSION ENTRIES COLUMNS COMPRESSED_BYTES UNCOMPRESSED_BYTES
+    for (std::size_t i = 0; i < record.size(); ++i) {
+      std::cout << (i == 0 ? "" : "\t") << record[i].second.value;
+    }
+    std::cout << std::endl;
   } else {
-    bmTreeSize(inputPath, storeName);
+    // Tagged with the medium and thread count like the bm_readspeed records, so both can be matched
+    // by the same configuration. The file is opened by a single thread.
+    MetricsRecord_t tags;
+    addMetric(tags, "medium", medium);
+    addMetric(tags, "threads", 1);
+    record.insert(record.begin() + 2, tags.begin(), tags.end());
+    record.insert(record.begin(), {"file", MetricsValue{inputPath, false}});
+    record.insert(record.end(), memoryRecord.begin(), memoryRecord.end());
+    writeRecords(std::cout, {record}, outputFormat);
   }
 
   return 0;
@@ -0,0 +1,71 @@
+#include <malloc.h>
+
+#include <cstdlib>
+#include <new>
+
+#include "bm-utils/bm_memory.hxx"
+
+// Replacement of the global (non-aligned) operator new and delete that keeps track of the number
+// and size of the heap allocations in gAllocationCounters. Since the replacement happens at link
+// time, it also covers the allocations made by the ROOT libraries. The usable size of each
+// allocation is counted, so the bytes allocated and freed always match.
+
+namespace {
+
+void *countedAlloc(std::size_t size) {
+  void *ptr = std::malloc(size ? size : 1);
+  if (!ptr)
+    return nullptr;
+
+  const std::int64_t usableSize = malloc_usable_size(ptr);
+  auto &counters = gAllocationCounters;
+  counters.nAllocations.fetch_add(1, std::memory_order_relaxed);
+  counters.allocatedBytes.fetch_add(usableSize, std::memory_order_relaxed);
+  const auto liveBytes =
+      counters.liveBytes.fetch_add(usableSize, std::memory_order_relaxed) + usableSize;
+  auto peakBytes = counters.peakLiveBytes.load(std::memory_order_relaxed);
+  while (liveBytes > peakBytes &&
+         !counters.peakLiveBytes.compare_exchange_weak(peakBytes, liveBytes,
+                                                       std::memory_order_relaxed)) {
+  }
+  return ptr;
+}
+
+void countedFree(void *ptr) {
+  if (!ptr)
+    return;
+  gAllocationCounters.liveBytes.fetch_sub(malloc_usable_size(ptr), std::memory_order_relaxed);
+  std::free(ptr);
+}
+
+} // namespace
+
+void *operator new(std::size_t size) {
+  if (auto ptr = countedAlloc(size))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size) {
+  if (auto ptr = countedAlloc(size))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept { return countedAlloc(size); }
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+  return countedAlloc(size);
+}
+
+void operator delete(void *ptr) noexcept { countedFree(ptr); }
+
+void operator delete[](void *ptr) noexcept { countedFree(ptr); }
+
+void operator delete(void *ptr, std::size_t) noexcept { countedFree(ptr); }
+
+void operator delete[](void *ptr, std::size_t) noexcept { countedFree(ptr); }
+
+void operator delete(void *ptr, const std::nothrow_t &) noexcept { countedFree(ptr); }
+
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept { countedFree(ptr); }
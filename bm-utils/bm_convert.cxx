@@ -0,0 +1,422 @@
+#include <ROOT/RNTupleImporter.hxx>
+#include <ROOT/RNTupleOptions.hxx>
+
+#include <TChain.h>
+#include <TFile.h>
+#include <TFileMerger.h>
+#include <TROOT.h>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "bm-utils/bm_options.hxx"
+#include "bm-utils/bm_output.hxx"
+#include "bm-utils/bm_tree.hxx"
+
+using ROOT::Experimental::RNTupleImporter;
+
+// Converts DAOD_PHYS TTree source files into TTree and RNTuple benchmark input files for a number
+// of compression settings. Each conversion runs in its own process, so multiple settings are
+// converted in parallel and the peak memory usage of each conversion can be measured. The TTree
+// files are written first (in the same way as `hadd -fCOMPRESSION -O`); the RNTuple files are then
+// imported from the TTree file with the same compression setting.
+
+struct ConvertConfig {
+  std::vector<std::string> sourcePaths;
+  std::string treeName = "CollectionTree";
+  std::string outputDir = ".";
+  std::string outputPrefix = "DAOD_PHYS";
+  std::vector<int> compressionSettings = {0, 201, 207, 404, 505};
+  bool writeTree = true;
+  bool writeNTuple = true;
+  // Approximate compressed cluster size (RNTuple) or auto-flush size (TTree), in bytes.
+  std::size_t clusterSize = 0;
+  // Approximate uncompressed page size (RNTuple) or basket size (TTree), in bytes.
+  std::size_t pageSize = 0;
+  unsigned nParallelJobs = 1;
+  // Number of implicit MT threads per conversion, used for parallel compression.
+  unsigned nThreads = 0;
+  bool force = false;
+  EOutputFormat outputFormat = EOutputFormat::kText;
+};
+
+struct ConvertJob {
+  bool isRNTuple;
+  int compression;
+  std::vector<std::string> sourcePaths;
+  std::string targetPath;
+};
+
+struct ConvertResult {
+  ConvertJob job;
+  bool skipped;
+  bool success;
+  double wallTime; // in seconds
+  double cpuTime;  // in seconds
+  long maxRSS;     // in kB
+  std::uintmax_t outputBytes;
+  // Effective basket sizes of the TTree output
+  BasketSizeStats basketSizes;
+};
+
+std::string getTargetPath(const ConvertConfig &config, bool isRNTuple, int compression) {
+  return config.outputDir + "/" + config.outputPrefix + (isRNTuple ? ".rntuple" : ".ttree") +
+         ".root~" + std::to_string(compression);
+}
+
+// A target is up to date when it is newer than all of its sources.
+bool isUpToDate(const ConvertJob &job) {
+  if (!std::filesystem::exists(job.targetPath))
+    return false;
+
+  const auto targetTime = std::filesystem::last_write_time(job.targetPath);
+  for (const auto &source : job.sourcePaths) {
+    if (std::filesystem::exists(source) && std::filesystem::last_write_time(source) > targetTime)
+      return false;
+  }
+  return true;
+}
+
+// With an explicit cluster or basket size, the entries are copied one by one into a clone of the
+// source tree with these settings. Unlike the merger, this only copies the tree itself.
+bool cloneTree(const ConvertJob &job, const ConvertConfig &config) {
+  TChain chain(config.treeName.c_str());
+  for (const auto &source : job.sourcePaths) {
+    chain.Add(source.c_str());
+  }
+
+  auto file = std::unique_ptr<TFile>(
+      TFile::Open(job.targetPath.c_str(), "RECREATE", "", job.compression));
+  if (!file || file->IsZombie())
+    return false;
+
+  auto tree = chain.CloneTree(0);
+  if (!tree)
+    return false;
+  tree->SetDirectory(file.get());
+  if (config.clusterSize > 0)
+    tree->SetAutoFlush(-static_cast<Long64_t>(config.clusterSize));
+  if (config.pageSize > 0)
+    tree->SetBasketSize("*", config.pageSize);
+
+  if (tree->CopyEntries(&chain) < 0)
+    return false;
+  return file->Write() > 0;
+}
+
+bool convertTree(const ConvertJob &job, const ConvertConfig &config) {
+  if (config.clusterSize > 0 || config.pageSize > 0)
+    return cloneTree(job, config);
+
+  TFileMerger merger(false, false);
+  merger.SetMsgPrefix("bm_convert");
+  merger.SetPrintLevel(0);
+  // Like `hadd -O`, re-optimize the baskets instead of copying them, so the requested compression
+  // setting is applied.
+  merger.SetFastMethod(false);
+  if (!merger.OutputFile(job.targetPath.c_str(), "RECREATE", job.compression))
+    return false;
+
+  for (const auto &source : job.sourcePaths) {
+    if (!merger.AddFile(source.c_str()))
+      return false;
+  }
+
+  return merger.Merge();
+}
+
+bool convertNTuple(const ConvertJob &job, const ConvertConfig &config) {
+  std::filesystem::remove(job.targetPath);
+
+  auto importer = RNTupleImporter::Create(job.sourcePaths[0], config.treeName, job.targetPath);
+  importer->SetIsQuiet(true);
+  importer->SetConvertDotsInBranchNames(true);
+  auto writeOptions = importer->GetWriteOptions();
+  writeOptions.SetCompression(job.compression);
+  if (config.clusterSize > 0)
+    writeOptions.SetApproxZippedClusterSize(config.clusterSize);
+  if (config.pageSize > 0)
+    writeOptions.SetApproxUnzippedPageSize(config.pageSize);
+  importer->SetWriteOptions(writeOptions);
+  importer->Import();
+
+  return true;
+}
+
+int runJob(const ConvertJob &job, const ConvertConfig &config) {
+  if (config.nThreads > 0)
+    ROOT::EnableImplicitMT(config.nThreads);
+
+  bool success = false;
+  try {
+    success = job.isRNTuple ? convertNTuple(job, config) : convertTree(job, config);
+  } catch (const std::exception &e) {
+    std::cerr << "ERROR: converting to " << job.targetPath << " failed: " << e.what() << std::endl;
+  }
+
+  if (!success)
+    std::filesystem::remove(job.targetPath);
+  return success ? 0 : 1;
+}
+
+// Runs the jobs with at most nParallelJobs processes at the same time.
+std::vector<ConvertResult> runJobs(const std::vector<ConvertJob> &jobs,
+                                   const ConvertConfig &config) {
+  std::vector<ConvertResult> results;
+  std::map<pid_t, std::pair<ConvertJob, std::chrono::steady_clock::time_point>> running;
+
+  auto nextJob = jobs.begin();
+  while (nextJob != jobs.end() || !running.empty()) {
+    while (nextJob != jobs.end() && running.size() < config.nParallelJobs) {
+      const auto &job = *nextJob++;
+      if (!config.force && isUpToDate(job)) {
+        results.emplace_back(ConvertResult{job, true, true, 0., 0., 0, 0});
+        continue;
+      }
+
+      std::cout.flush();
+      pid_t pid = fork();
+      if (pid < 0) {
+        std::cerr << "ERROR: could not start the conversion to " << job.targetPath << std::endl;
+        results.emplace_back(ConvertResult{job, false, false, 0., 0., 0, 0});
+        continue;
+      }
+      if (pid == 0) {
+        const int exitCode = runJob(job, config);
+        std::cout.flush();
+        _exit(exitCode);
+      }
+      running[pid] = {job, std::chrono::steady_clock::now()};
+    }
+
+    if (running.empty())
+      continue;
+
+    int status;
+    struct rusage usage;
+    pid_t pid = wait4(-1, &status, 0, &usage);
+    if (pid < 0)
+      break;
+
+    const auto &[job, start] = running[pid];
+    ConvertResult result{job, false, WIFEXITED(status) && WEXITSTATUS(status) == 0, 0., 0., 0, 0};
+    result.wallTime =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.cpuTime = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 + usage.ru_stime.tv_sec +
+                     usage.ru_stime.tv_usec / 1e6;
+    result.maxRSS = usage.ru_maxrss;
+    if (result.success) {
+      result.outputBytes = std::filesystem::file_size(job.targetPath);
+      if (!job.isRNTuple)
+        result.basketSizes = getBasketSizeStats(job.targetPath, config.treeName);
+    }
+    results.emplace_back(std::move(result));
+    running.erase(pid);
+  }
+
+  return results;
+}
+
+std::vector<MetricsRecord_t> getRecords(const std::vector<ConvertResult> &results,
+                                        std::uint64_t nEvents) {
+  std::vector<MetricsRecord_t> records;
+  for (const auto &r : results) {
+    MetricsRecord_t record;
+    addMetric(record, "file", r.job.targetPath);
+    addMetric(record, "format", r.job.isRNTuple ? "rntuple" : "ttree");
+    addMetric(record, "compression", r.job.compression);
+    addMetric(record, "status", r.skipped ? "skipped" : (r.success ? "converted" : "failed"));
+    addMetric(record, "events", nEvents);
+    addMetric(record, "output_bytes", r.outputBytes);
+    addMetric(record, "wall_time_s", r.wallTime);
+    addMetric(record, "cpu_time_s", r.cpuTime);
+    addMetric(record, "events_per_s", r.wallTime > 0 ? nEvents / r.wallTime : 0.);
+    addMetric(record, "mb_per_s", r.wallTime > 0 ? r.outputBytes / 1e6 / r.wallTime : 0.);
+    addMetric(record, "peak_rss_kb", r.maxRSS);
+    // Zero for RNTuple, which writes pages of the requested size.
+    addMetric(record, "basket_size_min", r.basketSizes.minBufferSize);
+    addMetric(record, "basket_size_max", r.basketSizes.maxBufferSize);
+    addMetric(record, "basket_size_mean", r.basketSizes.meanBufferSize);
+    addMetric(record, "basket_bytes_mean", r.basketSizes.meanBasketBytes);
+    records.emplace_back(std::move(record));
+  }
+  return records;
+}
+
+void printResults(const std::vector<MetricsRecord_t> &records) {
+  for (std::size_t i = 0; i < records[0].size(); ++i) {
+    std::cout << (i == 0 ? "" : "\t") << records[0][i].first;
+  }
+  std::cout << std::endl;
+
+  for (const auto &record : records) {
+    for (std::size_t i = 0; i < record.size(); ++i) {
+      std::cout << (i == 0 ? "" : "\t") << record[i].second.value;
+    }
+    std::cout << std::endl;
+  }
+}
+
+std::vector<int> parseCompressionSettings(const std::string &arg) {
+  std::vector<int> settings;
+  std::stringstream ss(arg);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    settings.emplace_back(std::atoi(item.c_str()));
+  }
+  return settings;
+}
+
+static void printUsage(std::string_view prog) {
+  std::cout << "USAGE: " << prog
+            << " (-h|-i SOURCE_PATH [-i SOURCE_PATH...] [-n TREE_NAME] [-d OUTPUT_DIR] "
+               "[-p OUTPUT_PREFIX] [-c COMPRESSION[,COMPRESSION...]] [-s (ttree|rntuple|both)] "
+               "[-C CLUSTER_SIZE] [-P PAGE_SIZE] [-j N_PARALLEL_JOBS] [-t N_THREADS] [-f] "
+               "[-o (text|json|csv)])"
+            << std::endl;
+}
+
+int main(int argc, char **argv) {
+  // Suppress (irrelevant) warnings
+  gErrorIgnoreLevel = kError;
+
+  ConvertConfig config;
+
+  int c;
+  while ((c = getopt(argc, argv, "hi:n:d:p:c:s:C:P:j:t:fo:")) != -1) {
+    switch (c) {
+    case 'h':
+      printUsage(argv[0]);
+      return 0;
+    case 'i':
+      config.sourcePaths.emplace_back(optarg);
+      break;
+    case 'n':
+      config.treeName = optarg;
+      break;
+    case 'd':
+      config.outputDir = optarg;
+      break;
+    case 'p':
+      config.outputPrefix = optarg;
+      break;
+    case 'c':
+      config.compressionSettings = parseCompressionSettings(optarg);
+      break;
+    case 's':
+      if (strcmp(optarg, "ttree") == 0) {
+        config.writeNTuple = false;
+      } else if (strcmp(optarg, "rntuple") == 0) {
+        config.writeTree = false;
+      } else if (strcmp(optarg, "both") != 0) {
+        std::cerr << "ERROR: Unknown storage mode " << optarg << std::endl;
+        return 1;
+      }
+      break;
+    case 'C':
+      if (!parseUnsigned(optarg, config.clusterSize)) {
+        std::cerr << "ERROR: invalid cluster size " << optarg << std::endl;
+        return 1;
+      }
+      break;
+    case 'P':
+      if (!parseUnsigned(optarg, config.pageSize)) {
+        std::cerr << "ERROR: invalid page size " << optarg << std::endl;
+        return 1;
+      }
+      break;
+    case 'j':
+      if (!parseUnsigned(optarg, config.nParallelJobs)) {
+        std::cerr << "ERROR: invalid number of parallel jobs " << optarg << std::endl;
+        return 1;
+      }
+      if (config.nParallelJobs == 0) {
+        std::cerr << "ERROR: the number of parallel jobs must be at least 1" << std::endl;
+        return 1;
+      }
+      break;
+    case 't':
+      if (!parseUnsigned(optarg, config.nThreads)) {
+        std::cerr << "ERROR: invalid number of threads " << optarg << std::endl;
+        return 1;
+      }
+      break;
+    case 'f':
+      config.force = true;
+      break;
+    case 'o':
+      if (!parseOutputFormat(optarg, config.outputFormat)) {
+        std::cerr << "ERROR: Unknown output format " << optarg << std::endl;
+        return 1;
+      }
+      break;
+    default:
+      printUsage(argv[0]);
+      return 1;
+    }
+  }
+
+  if (config.sourcePaths.empty()) {
+    std::cerr << "ERROR: please provide at least one source path\n" << std::endl;
+    printUsage(argv[0]);
+    return 1;
+  }
+
+  if (!config.writeTree && config.sourcePaths.size() > 1) {
+    std::cerr << "ERROR: multiple source files can only be imported into RNTuple through TTree"
+              << std::endl;
+    return 1;
+  }
+
+  std::uint64_t nEvents = 0;
+  {
+    TChain chain(config.treeName.c_str());
+    for (const auto &source : config.sourcePaths) {
+      chain.Add(source.c_str());
+    }
+    nEvents = chain.GetEntries();
+  }
+
+  std::filesystem::create_directories(config.outputDir);
+
+  std::vector<ConvertJob> treeJobs, ntupleJobs;
+  for (const auto compression : config.compressionSettings) {
+    const auto treePath = getTargetPath(config, false, compression);
+    if (config.writeTree)
+      treeJobs.emplace_back(ConvertJob{false, compression, config.sourcePaths, treePath});
+    if (config.writeNTuple) {
+      const auto ntupleSource = config.writeTree ? treePath : config.sourcePaths[0];
+      ntupleJobs.emplace_back(ConvertJob{true, compression, {ntupleSource},
+                                         getTargetPath(config, true, compression)});
+    }
+  }
+
+  // The RNTuple files are imported from the TTree files, so these have to be written first.
+  auto results = runJobs(treeJobs, config);
+  auto ntupleResults = runJobs(ntupleJobs, config);
+  results.insert(results.end(), ntupleResults.begin(), ntupleResults.end());
+
+  if (results.empty())
+    return 0;
+
+  const auto records = getRecords(results, nEvents);
+  if (config.outputFormat == EOutputFormat::kText)
+    printResults(records);
+  else
+    writeRecords(std::cout, records, config.outputFormat);
+
+  return std::all_of(results.begin(), results.end(), [](const auto &r) { return r.success; }) ? 0
+                                                                                             : 1;
+}
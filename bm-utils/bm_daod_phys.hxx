@@ -0,0 +1,204 @@
+#ifndef ATLAS_BM_DAOD_PHYS_H
+#define ATLAS_BM_DAOD_PHYS_H
+
+#include <ROOT/REntry.hxx>
+#include <ROOT/RField.hxx>
+#include <ROOT/RNTupleModel.hxx>
+
+#include <TTree.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// In-memory representation of a synthetic DAOD_PHYS-like event, shared by the tools that write
+// such events (gen_daod_phys, bm_writespeed). An event contains the kinematics of the containers
+// below as read by bm_readspeed, plus a configurable number of additional int, char and nested
+// vector columns. The storage of each column is owned by the event and bound to both the RNTuple
+// entry and the TTree branch.
+
+struct ContainerInfo {
+  std::string_view name;
+  double meanMultiplicity; // mean of the Poisson-distributed number of objects per event
+  double meanPt;           // in MeV
+};
+
+// Mean multiplicities roughly follow those of the ttbar MC sample used in the CHEP 2023 benchmarks.
+inline const std::array<ContainerInfo, 8> kContainers = {
+    {{"Electrons", 3., 25000.},
+     {"Photons", 4., 15000.},
+     {"TauJets", 4., 20000.},
+     {"TauJets_MuonRM", 4., 20000.},
+     {"DiTauJets", 1., 60000.},
+     {"DiTauJetsLowPt", 2., 30000.},
+     {"TauNeutralParticleFlowObjects", 15., 2000.},
+     {"TauNeutralParticleFlowObjects_MuonRM", 15., 2000.}}};
+
+inline const std::array<std::string_view, 4> kKinematics = {"pt", "eta", "phi", "m"};
+
+struct ExtraColumns {
+  unsigned nIntColumns = 0;
+  unsigned nCharColumns = 0;
+  unsigned nNestedColumns = 0;
+};
+
+template <typename T> struct Column {
+  std::string name;
+  std::shared_ptr<T> value;
+};
+
+// All columns of a container share the multiplicity of that container.
+struct ContainerColumns {
+  const ContainerInfo *info;
+  std::array<Column<std::vector<float>>, 4> kinematics;
+  std::vector<Column<std::vector<std::int32_t>>> ints;
+  std::vector<Column<std::vector<char>>> chars;
+  std::vector<Column<std::vector<std::vector<float>>>> nested;
+};
+
+typedef std::vector<ContainerColumns> DaodPhysEvent_t;
+
+// TTree branch names use a '.' between the container and the variable, while the corresponding
+// RNTuple field names use a '_' (like the RNTupleImporter does when converting dots).
+inline std::string getFieldName(std::string_view container, std::string_view var) {
+  return std::string(container) + "AuxDyn_" + std::string(var);
+}
+
+inline std::string getBranchName(std::string_view container, std::string_view var) {
+  return std::string(container) + "AuxDyn." + std::string(var);
+}
+
+template <typename T> Column<T> makeColumn(std::string name) {
+  return Column<T>{std::move(name), std::make_shared<T>()};
+}
+
+inline DaodPhysEvent_t createEvent(const ExtraColumns &extra) {
+  DaodPhysEvent_t event;
+  for (const auto &info : kContainers) {
+    ContainerColumns cols{&info, {}, {}, {}, {}};
+    for (std::size_t k = 0; k < kKinematics.size(); ++k) {
+      cols.kinematics[k] = makeColumn<std::vector<float>>(std::string(kKinematics[k]));
+    }
+    event.emplace_back(std::move(cols));
+  }
+
+  // The additional columns are distributed round-robin over the containers.
+  for (unsigned i = 0; i < extra.nIntColumns; ++i) {
+    event[i % event.size()].ints.emplace_back(
+        makeColumn<std::vector<std::int32_t>>("intVar" + std::to_string(i)));
+  }
+  for (unsigned i = 0; i < extra.nCharColumns; ++i) {
+    event[i % event.size()].chars.emplace_back(
+        makeColumn<std::vector<char>>("charVar" + std::to_string(i)));
+  }
+  for (unsigned i = 0; i < extra.nNestedColumns; ++i) {
+    event[i % event.size()].nested.emplace_back(
+        makeColumn<std::vector<std::vector<float>>>("nestedVar" + std::to_string(i)));
+  }
+
+  return event;
+}
+
+// Calls f(containerName, varName, value) for every column of the event, where value is the shared
+// pointer to the column's storage.
+template <typename F> void forEachColumn(DaodPhysEvent_t &event, F &&f) {
+  for (auto &cols : event) {
+    for (auto &col : cols.kinematics)
+      f(cols.info->name, col.name, col.value);
+    for (auto &col : cols.ints)
+      f(cols.info->name, col.name, col.value);
+    for (auto &col : cols.chars)
+      f(cols.info->name, col.name, col.value);
+    for (auto &col : cols.nested)
+      f(cols.info->name, col.name, col.value);
+  }
+}
+
+// Adds a field for every column of the event to the model.
+inline void addFields(ROOT::Experimental::RNTupleModel &model, DaodPhysEvent_t &event) {
+  forEachColumn(event, [&](std::string_view container, const std::string &var, auto &value) {
+    using Value_t = typename std::decay_t<decltype(value)>::element_type;
+    model.AddField(
+        std::make_unique<ROOT::Experimental::RField<Value_t>>(getFieldName(container, var)));
+  });
+}
+
+// Binds the storage of the event to an entry created from a model filled by addFields().
+inline void bindEntry(ROOT::Experimental::REntry &entry, DaodPhysEvent_t &event) {
+  forEachColumn(event, [&](std::string_view container, const std::string &var, auto &value) {
+    entry.BindValue(getFieldName(container, var), value);
+  });
+}
+
+// Adds a branch for every column of the event to the tree, with the event's storage as address.
+inline void addBranches(TTree &tree, DaodPhysEvent_t &event) {
+  forEachColumn(event, [&](std::string_view container, const std::string &var, auto &value) {
+    tree.Branch(getBranchName(container, var).c_str(), value.get());
+  });
+}
+
+inline void generateEvent(DaodPhysEvent_t &event, std::mt19937_64 &rng) {
+  std::uniform_real_distribution<float> phiDist(-M_PI, M_PI);
+  std::normal_distribution<float> etaDist(0., 1.5);
+  std::uniform_int_distribution<std::int32_t> intDist(0, 1000);
+  std::bernoulli_distribution charDist(0.5);
+  std::poisson_distribution<unsigned> nestedSizeDist(3.);
+
+  for (auto &cols : event) {
+    const auto n = std::poisson_distribution<unsigned>(cols.info->meanMultiplicity)(rng);
+    std::exponential_distribution<float> ptDist(1. / cols.info->meanPt);
+
+    for (auto &k : cols.kinematics) {
+      k.value->resize(n);
+    }
+    for (unsigned i = 0; i < n; ++i) {
+      (*cols.kinematics[0].value)[i] = ptDist(rng);
+      (*cols.kinematics[1].value)[i] = std::clamp(etaDist(rng), -4.9f, 4.9f);
+      (*cols.kinematics[2].value)[i] = phiDist(rng);
+      (*cols.kinematics[3].value)[i] = 0.1f * ptDist(rng);
+    }
+
+    for (auto &col : cols.ints) {
+      col.value->resize(n);
+      for (auto &v : *col.value)
+        v = intDist(rng);
+    }
+    for (auto &col : cols.chars) {
+      col.value->resize(n);
+      for (auto &v : *col.value)
+        v = charDist(rng);
+    }
+    for (auto &col : cols.nested) {
+      col.value->resize(n);
+      for (auto &inner : *col.value) {
+        inner.resize(nestedSizeDist(rng));
+        for (auto &v : inner)
+          v = ptDist(rng);
+      }
+    }
+  }
+}
+
+// Copies the values of one event into another event with the same columns, keeping the storage of
+// the target (and hence its bindings) intact.
+inline void copyEvent(const DaodPhysEvent_t &from, DaodPhysEvent_t &to) {
+  for (std::size_t c = 0; c < from.size(); ++c) {
+    for (std::size_t i = 0; i < from[c].kinematics.size(); ++i)
+      *to[c].kinematics[i].value = *from[c].kinematics[i].value;
+    for (std::size_t i = 0; i < from[c].ints.size(); ++i)
+      *to[c].ints[i].value = *from[c].ints[i].value;
+    for (std::size_t i = 0; i < from[c].chars.size(); ++i)
+      *to[c].chars[i].value = *from[c].chars[i].value;
+    for (std::size_t i = 0; i < from[c].nested.size(); ++i)
+      *to[c].nested[i].value = *from[c].nested[i].value;
+  }
+}
+
+#endif // ATLAS_BM_DAOD_PHYS_H
@@ -0,0 +1,380 @@
+#include <ROOT/RNTuple.hxx>
+#include <ROOT/RNTupleInspector.hxx>
+#include <ROOT/RNTupleModel.hxx>
+#include <ROOT/RNTupleOptions.hxx>
+
+#include <TROOT.h>
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include "bm-utils/bm_ntuple_compat.hxx"
+
+using ROOT::Experimental::NTupleSize_t;
+using ROOT::Experimental::RNTupleCollectionWriter;
+using ROOT::Experimental::RNTupleInspector;
+using ROOT::Experimental::RNTupleModel;
+using ROOT::Experimental::RNTupleReader;
+using ROOT::Experimental::RNTupleView;
+using ROOT::Experimental::RNTupleViewCollection;
+using ROOT::Experimental::RNTupleWriteOptions;
+using ROOT::Experimental::RNTupleWriter;
+
+// Prototype of collection index (offset) column deduplication. All `std::vector<T>` AuxDyn fields
+// of a container have the same number of elements per entry, so their offset columns are
+// identical (see bm-size/bm_index_field_size.cxx). This tool writes two variants of the AuxDyn
+// vector fields of an RNTuple, with the same write options:
+//   baseline -- every field as a separate `std::vector<T>` (CONTAINERAuxDyn_VAR), as imported
+//   shared   -- one collection per container (CONTAINERAuxDyn) with a field per variable (VAR),
+//               so all variables share a single offset column
+// The largest group of fields of a container with the same size in every entry shares the offset
+// column; the other fields are kept as separate vectors in both variants. The size and read speed
+// of both variants can then be compared with bm_size and bm_readspeed.
+
+struct DedupConfig {
+  std::string inputPath;
+  std::string ntupleName = "CollectionTree";
+  std::string outputDir = ".";
+  std::string outputPrefix = "DAOD_PHYS";
+  std::regex containerRegex{".*"};
+  int compression = -1;
+};
+
+// The AuxDyn vector fields of a container, split by whether they can share the offset column.
+struct ContainerPlan {
+  std::string name;
+  std::vector<std::pair<std::string, std::string>> sharedFields;     // (field name, type name)
+  std::vector<std::pair<std::string, std::string>> standaloneFields; // (field name, type name)
+};
+
+// Copies the values of one `std::vector<T>` field from the input, either as a vector field or as
+// the item field of a collection.
+class MemberCopier {
+public:
+  virtual ~MemberCopier() = default;
+  virtual void addVectorField(RNTupleModel &model) = 0;
+  virtual void addItemField(RNTupleModel &collectionModel) = 0;
+  virtual void read(NTupleSize_t entry) = 0;
+  virtual std::size_t getSize() const = 0;
+  virtual void copyVector() = 0;
+  virtual void copyItem(std::size_t index) = 0;
+};
+
+template <typename T> class TypedMemberCopier : public MemberCopier {
+  std::string fFieldName;
+  std::string fMemberName;
+  RNTupleView<std::vector<T>> fView;
+  const std::vector<T> *fValue = nullptr;
+  std::shared_ptr<std::vector<T>> fVectorPtr;
+  std::shared_ptr<T> fItemPtr;
+
+public:
+  TypedMemberCopier(RNTupleReader &reader, const std::string &fieldName,
+                    const std::string &memberName)
+      : fFieldName(fieldName), fMemberName(memberName),
+        fView(reader.GetView<std::vector<T>>(fieldName)) {}
+
+  void addVectorField(RNTupleModel &model) final {
+    fVectorPtr = model.MakeField<std::vector<T>>(fFieldName);
+  }
+  void addItemField(RNTupleModel &collectionModel) final {
+    fItemPtr = collectionModel.MakeField<T>(fMemberName);
+  }
+  void read(NTupleSize_t entry) final { fValue = &fView(entry); }
+  std::size_t getSize() const final { return fValue->size(); }
+  void copyVector() final { *fVectorPtr = *fValue; }
+  void copyItem(std::size_t index) final { *fItemPtr = (*fValue)[index]; }
+};
+
+std::unique_ptr<MemberCopier> createMemberCopier(RNTupleReader &reader,
+                                                 const std::string &fieldName,
+                                                 const std::string &typeName,
+                                                 const std::string &memberName) {
+  if (typeName == "std::vector<float>")
+    return std::make_unique<TypedMemberCopier<float>>(reader, fieldName, memberName);
+  if (typeName == "std::vector<double>")
+    return std::make_unique<TypedMemberCopier<double>>(reader, fieldName, memberName);
+  if (typeName == "std::vector<char>")
+    return std::make_unique<TypedMemberCopier<char>>(reader, fieldName, memberName);
+  if (typeName == "std::vector<std::int8_t>")
+    return std::make_unique<TypedMemberCopier<std::int8_t>>(reader, fieldName, memberName);
+  if (typeName == "std::vector<std::uint8_t>")
+    return std::make_unique<TypedMemberCopier<std::uint8_t>>(reader, fieldName, memberName);
+  if (typeName == "std::vector<std::int16_t>")
+    return std::make_unique<TypedMemberCopier<std::int16_t>>(reader, fieldName, memberName);
+  if (typeName == "std::vector<std::uint16_t>")
+    return std::make_unique<TypedMemberCopier<std::uint16_t>>(reader, fieldName, memberName);
+  if (typeName == "std::vector<std::int32_t>")
+    return std::make_unique<TypedMemberCopier<std::int32_t>>(reader, fieldName, memberName);
+  if (typeName == "std::vector<std::uint32_t>")
+    return std::make_unique<TypedMemberCopier<std::uint32_t>>(reader, fieldName, memberName);
+  if (typeName == "std::vector<std::int64_t>")
+    return std::make_unique<TypedMemberCopier<std::int64_t>>(reader, fieldName, memberName);
+  if (typeName == "std::vector<std::uint64_t>")
+    return std::make_unique<TypedMemberCopier<std::uint64_t>>(reader, fieldName, memberName);
+  return nullptr;
+}
+
+bool isSupportedType(const std::string &typeName) {
+  static const std::regex supportedRegex(
+      R"(std::vector<(float|double|char|std::u?int(8|16|32|64)_t)>)");
+  return std::regex_match(typeName, supportedRegex);
+}
+
+// Splits "CONTAINERAuxDyn_VAR" into the container and the variable name.
+bool splitFieldName(const std::string &fieldName, std::string &container, std::string &var) {
+  static const std::regex auxDynRegex(R"((.+AuxDyn)_(.+))");
+  std::smatch match;
+  if (!std::regex_match(fieldName, match, auxDynRegex))
+    return false;
+  container = match[1];
+  var = match[2];
+  return true;
+}
+
+std::vector<ContainerPlan> createPlans(const DedupConfig &config) {
+  auto inspector = RNTupleInspector::Create(config.ntupleName, config.inputPath);
+  auto reader = RNTupleReader::Open(config.ntupleName, config.inputPath);
+
+  std::vector<ContainerPlan> plans;
+  for (const auto &fld : inspector->GetDescriptor()->GetTopLevelFields()) {
+    std::string container, var;
+    if (!isSupportedType(fld.GetTypeName()) || !splitFieldName(fld.GetFieldName(), container, var))
+      continue;
+    if (!std::regex_match(container, config.containerRegex))
+      continue;
+
+    auto plan = std::find_if(plans.begin(), plans.end(),
+                             [&](const auto &p) { return p.name == container; });
+    if (plan == plans.end()) {
+      plans.emplace_back(ContainerPlan{container, {}, {}});
+      plan = plans.end() - 1;
+    }
+    plan->sharedFields.emplace_back(fld.GetFieldName(), fld.GetTypeName());
+  }
+
+  // The fields of a container are grouped by their sequence of per-entry sizes, and the largest
+  // group shares the offset column. The fields are first grouped by a hash of the sequence, and
+  // the largest group is then checked entry by entry against its first field, so a hash collision
+  // cannot merge fields with different sizes. This only reads the offset columns.
+  for (auto &plan : plans) {
+    std::vector<RNTupleViewCollection> views;
+    for (const auto &[fieldName, _] : plan.sharedFields) {
+      views.emplace_back(reader->GetViewCollection(fieldName));
+    }
+
+    // FNV-1a over the sizes of all entries
+    std::vector<std::uint64_t> sizeHashes(views.size(), 14695981039346656037ULL);
+    for (auto i : reader->GetEntryRange()) {
+      for (std::size_t f = 0; f < views.size(); ++f) {
+        sizeHashes[f] ^= views[f].GetCollectionRange(i).size();
+        sizeHashes[f] *= 1099511628211ULL;
+      }
+    }
+
+    // On ties, the group of the earliest field is taken.
+    std::map<std::uint64_t, std::size_t> groupSizes;
+    for (const auto hash : sizeHashes) {
+      ++groupSizes[hash];
+    }
+    std::uint64_t sharedHash = sizeHashes[0];
+    for (const auto hash : sizeHashes) {
+      if (groupSizes[hash] > groupSizes[sharedHash])
+        sharedHash = hash;
+    }
+
+    std::vector<bool> isShared(views.size());
+    for (std::size_t f = 0; f < views.size(); ++f) {
+      isShared[f] = sizeHashes[f] == sharedHash;
+    }
+    const std::size_t ref = std::find(isShared.begin(), isShared.end(), true) - isShared.begin();
+    for (auto i : reader->GetEntryRange()) {
+      const auto refSize = views[ref].GetCollectionRange(i).size();
+      for (std::size_t f = ref + 1; f < views.size(); ++f) {
+        if (isShared[f] && views[f].GetCollectionRange(i).size() != refSize)
+          isShared[f] = false;
+      }
+    }
+
+    std::vector<std::pair<std::string, std::string>> sharedFields;
+    for (std::size_t f = 0; f < views.size(); ++f) {
+      if (isShared[f])
+        sharedFields.emplace_back(plan.sharedFields[f]);
+      else
+        plan.standaloneFields.emplace_back(plan.sharedFields[f]);
+    }
+    plan.sharedFields = sharedFields;
+  }
+
+  return plans;
+}
+
+struct ContainerWriter {
+  std::vector<std::unique_ptr<MemberCopier>> sharedMembers;
+  std::vector<std::unique_ptr<MemberCopier>> vectorMembers;
+  std::shared_ptr<RNTupleCollectionWriter> collection;
+};
+
+std::string getOutputPath(const DedupConfig &config, bool shareOffsets, int compression) {
+  return config.outputDir + "/" + config.outputPrefix +
+         (shareOffsets ? ".rntuple_shared" : ".rntuple_baseline") + ".root~" +
+         std::to_string(compression);
+}
+
+void writeVariant(const DedupConfig &config, const std::vector<ContainerPlan> &plans,
+                  bool shareOffsets, int compression) {
+  auto reader = RNTupleReader::Open(config.ntupleName, config.inputPath);
+  auto model = RNTupleModel::Create();
+
+  std::vector<ContainerWriter> containers;
+  for (const auto &plan : plans) {
+    ContainerWriter container;
+    // Sharing the offset column of a single field does not save anything.
+    const bool isCollection = shareOffsets && plan.sharedFields.size() > 1;
+
+    auto collectionModel = RNTupleModel::Create();
+    for (const auto &[fieldName, typeName] : plan.sharedFields) {
+      const auto memberName = fieldName.substr(plan.name.size() + 1);
+      auto member = createMemberCopier(*reader, fieldName, typeName, memberName);
+      if (isCollection) {
+        member->addItemField(*collectionModel);
+        container.sharedMembers.emplace_back(std::move(member));
+      } else {
+        member->addVectorField(*model);
+        container.vectorMembers.emplace_back(std::move(member));
+      }
+    }
+    if (isCollection)
+      container.collection = model->MakeCollection(plan.name, std::move(collectionModel));
+
+    for (const auto &[fieldName, typeName] : plan.standaloneFields) {
+      auto member = createMemberCopier(*reader, fieldName, typeName, fieldName);
+      member->addVectorField(*model);
+      container.vectorMembers.emplace_back(std::move(member));
+    }
+
+    containers.emplace_back(std::move(container));
+  }
+
+  RNTupleWriteOptions writeOptions;
+  writeOptions.SetCompression(compression);
+  const auto outputPath = getOutputPath(config, shareOffsets, compression);
+  auto writer =
+      RNTupleWriter::Recreate(std::move(model), config.ntupleName, outputPath, writeOptions);
+
+  for (auto i : reader->GetEntryRange()) {
+    for (auto &container : containers) {
+      for (auto &member : container.vectorMembers) {
+        member->read(i);
+        member->copyVector();
+      }
+
+      if (!container.collection)
+        continue;
+
+      for (auto &member : container.sharedMembers) {
+        member->read(i);
+      }
+      const auto nItems = container.sharedMembers[0]->getSize();
+      for (std::size_t j = 0; j < nItems; ++j) {
+        for (auto &member : container.sharedMembers) {
+          member->copyItem(j);
+        }
+        container.collection->Fill();
+      }
+    }
+    writer->Fill();
+  }
+
+  std::cout << "Wrote " << reader->GetNEntries() << " entries to " << outputPath << std::endl;
+}
+
+void printPlans(const std::vector<ContainerPlan> &plans) {
+  std::size_t nRemovedColumns = 0;
+  std::cout << "container\tshared_fields\tstandalone_fields" << std::endl;
+  for (const auto &plan : plans) {
+    std::cout << plan.name << "\t" << plan.sharedFields.size() << "\t"
+              << plan.standaloneFields.size() << std::endl;
+    if (plan.sharedFields.size() > 1)
+      nRemovedColumns += plan.sharedFields.size() - 1;
+  }
+  std::cout << "Offset columns removed: " << nRemovedColumns << std::endl;
+}
+
+static void printUsage(std::string_view prog) {
+  std::cout << "USAGE: " << prog
+            << " (-h|-i INPUT_PATH [-n NTUPLE_NAME] [-d OUTPUT_DIR] [-p OUTPUT_PREFIX] "
+               "[-x CONTAINER_REGEX] [-c COMPRESSION])"
+            << std::endl;
+}
+
+int main(int argc, char **argv) {
+  // Suppress (irrelevant) warnings
+  gErrorIgnoreLevel = kError;
+
+  DedupConfig config;
+
+  int c;
+  while ((c = getopt(argc, argv, "hi:n:d:p:x:c:")) != -1) {
+    switch (c) {
+    case 'h':
+      printUsage(argv[0]);
+      return 0;
+    case 'i':
+      config.inputPath = optarg;
+      break;
+    case 'n':
+      config.ntupleName = optarg;
+      break;
+    case 'd':
+      config.outputDir = optarg;
+      break;
+    case 'p':
+      config.outputPrefix = optarg;
+      break;
+    case 'x':
+      config.containerRegex = std::regex(optarg);
+      break;
+    case 'c':
+      config.compression = std::atoi(optarg);
+      break;
+    default:
+      printUsage(argv[0]);
+      return 1;
+    }
+  }
+
+  if (config.inputPath.empty()) {
+    std::cerr << "ERROR: please provide an input path\n" << std::endl;
+    printUsage(argv[0]);
+    return 1;
+  }
+
+  // By default, use the same compression settings as the input.
+  const int compression =
+      config.compression >= 0
+          ? config.compression
+          : RNTupleInspector::Create(config.ntupleName, config.inputPath)->GetCompressionSettings();
+
+  const auto plans = createPlans(config);
+  if (plans.empty()) {
+    std::cerr << "ERROR: no AuxDyn vector fields found" << std::endl;
+    return 1;
+  }
+  printPlans(plans);
+
+  std::filesystem::create_directories(config.outputDir);
+  writeVariant(config, plans, false, compression);
+  writeVariant(config, plans, true, compression);
+
+  return 0;
+}
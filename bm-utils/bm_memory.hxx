@@ -0,0 +1,79 @@
+#ifndef ATLAS_BM_MEMORY_H
+#define ATLAS_BM_MEMORY_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+// Measurement of the memory usage of the process. The current and peak resident set size are read
+// from /proc/self/status (VmRSS and VmHWM). The peak can be reset through /proc/self/clear_refs
+// (Linux 4.0 and newer), so it can be measured per benchmark run within the same process.
+
+inline void resetPeakRSS() {
+  std::ofstream clearRefs("/proc/self/clear_refs");
+  clearRefs << "5";
+}
+
+// Returns the value of a field of /proc/self/status in kB, or 0 if it is not available.
+inline long readProcStatus(const std::string &field) {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.compare(0, field.size(), field) == 0 && line[field.size()] == ':')
+      return std::atol(line.c_str() + field.size() + 1);
+  }
+  return 0;
+}
+
+// Returns the peak resident set size in kB, or 0 if it is not available.
+inline long getPeakRSS() { return readProcStatus("VmHWM"); }
+
+// Returns the current resident set size in kB, or 0 if it is not available.
+inline long getCurrentRSS() { return readProcStatus("VmRSS"); }
+
+// Heap allocation counters, which are updated by the replacement operator new and delete in
+// bm-utils/bm_alloc_counter.cxx. These are only compiled into the benchmarks with the CMake option
+// ATLAS_BM_COUNT_ALLOCATIONS, because counting slows down allocation-heavy code. Without it, the
+// counters remain zero. Allocations made directly with malloc are not counted.
+struct AllocationCounters {
+  std::atomic<std::uint64_t> nAllocations{0};
+  std::atomic<std::uint64_t> allocatedBytes{0};
+  std::atomic<std::int64_t> liveBytes{0};
+  std::atomic<std::int64_t> peakLiveBytes{0};
+  // Live bytes at the last reset, so the peak is relative to the start of a benchmark run.
+  std::atomic<std::int64_t> baselineBytes{0};
+};
+
+inline AllocationCounters gAllocationCounters;
+
+#ifdef ATLAS_BM_COUNT_ALLOCATIONS
+inline constexpr bool kCountAllocations = true;
+#else
+inline constexpr bool kCountAllocations = false;
+#endif
+
+struct AllocationStats {
+  std::uint64_t nAllocations = 0;
+  std::uint64_t allocatedBytes = 0; // in total, including memory that has been freed again
+  std::int64_t peakBytes = 0;       // peak of the live heap, above its size at the reset
+};
+
+inline void resetAllocationStats() {
+  const auto liveBytes = gAllocationCounters.liveBytes.load();
+  gAllocationCounters.nAllocations = 0;
+  gAllocationCounters.allocatedBytes = 0;
+  gAllocationCounters.baselineBytes = liveBytes;
+  gAllocationCounters.peakLiveBytes = liveBytes;
+}
+
+inline AllocationStats getAllocationStats() {
+  AllocationStats stats;
+  stats.nAllocations = gAllocationCounters.nAllocations;
+  stats.allocatedBytes = gAllocationCounters.allocatedBytes;
+  stats.peakBytes = gAllocationCounters.peakLiveBytes - gAllocationCounters.baselineBytes;
+  return stats;
+}
+
+#endif // ATLAS_BM_MEMORY_H
@@ -0,0 +1,30 @@
+#ifndef ATLAS_BM_NTUPLE_COMPAT_H
+#define ATLAS_BM_NTUPLE_COMPAT_H
+
+#include <ROOT/RColumnElement.hxx>
+#include <ROOT/RPageStorage.hxx>
+#include <RVersion.h>
+
+// The reader and writer were split off from ROOT/RNTuple.hxx into their own headers in ROOT 6.32.
+#if __has_include(<ROOT/RNTupleReader.hxx>)
+#include <ROOT/RNTupleReader.hxx>
+#include <ROOT/RNTupleWriter.hxx>
+#else
+#include <ROOT/RNTuple.hxx>
+#endif
+
+// Aliases for the RNTuple storage classes used by the benchmarks, which moved from the Detail to
+// the Internal namespace in ROOT 6.32. The benchmarks support ROOT 6.30 and 6.32; the tools that
+// need newer APIs are only built with ROOT 6.32 or newer (see the CMake configuration).
+
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6, 32, 0)
+using RColumnElementBase = ROOT::Experimental::Internal::RColumnElementBase;
+using RPageSource = ROOT::Experimental::Internal::RPageSource;
+using RPageStorage = ROOT::Experimental::Internal::RPageStorage;
+#else
+using RColumnElementBase = ROOT::Experimental::Detail::RColumnElementBase;
+using RPageSource = ROOT::Experimental::Detail::RPageSource;
+using RPageStorage = ROOT::Experimental::Detail::RPageStorage;
+#endif
+
+#endif // ATLAS_BM_NTUPLE_COMPAT_H
@@ -0,0 +1,43 @@
+#ifndef ATLAS_BM_OPTIONS_H
+#define ATLAS_BM_OPTIONS_H
+
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <limits>
+#include <type_traits>
+
+// Parses a non-negative decimal integer that fits into T, for size and count options. Unlike
+// std::atoi and std::strtoull, this rejects negative values (which std::strtoull wraps around),
+// trailing characters and values that are out of range.
+template <typename T> bool parseUnsigned(const char *arg, T &value) {
+  static_assert(std::is_unsigned_v<T>, "parseUnsigned requires an unsigned type");
+  if (!std::isdigit(static_cast<unsigned char>(arg[0])))
+    return false;
+
+  char *end = nullptr;
+  errno = 0;
+  const auto parsed = std::strtoull(arg, &end, 10);
+  if (errno == ERANGE || *end != '\0' || parsed > std::numeric_limits<T>::max())
+    return false;
+
+  value = static_cast<T>(parsed);
+  return true;
+}
+
+// Whether a ROOT compression setting (100 * algorithm + level) has a known algorithm, from 0 (the
+// default algorithm) to 5 (ZSTD), and a level from 0 to 9.
+inline bool isValidCompression(unsigned settings) {
+  return settings / 100 <= 5 && settings % 100 <= 9;
+}
+
+// Parses a ROOT compression setting, which is rejected if it is negative or not valid.
+inline bool parseCompression(const char *arg, int &compression) {
+  unsigned settings;
+  if (!parseUnsigned(arg, settings) || !isValidCompression(settings))
+    return false;
+  compression = static_cast<int>(settings);
+  return true;
+}
+
+#endif // ATLAS_BM_OPTIONS_H
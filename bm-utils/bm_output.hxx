@@ -0,0 +1,155 @@
+#ifndef ATLAS_BM_OUTPUT_H
+#define ATLAS_BM_OUTPUT_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Machine-readable (JSON or CSV) output of benchmark results. A result consists of a number of
+// records, each of which is an ordered list of key-value pairs. Keys and their order are determined
+// by the benchmark that produces the records, so they form a stable schema for downstream tools.
+
+enum class EOutputFormat { kText, kJSON, kCSV };
+
+struct MetricsValue {
+  std::string value;
+  bool isNumeric;
+};
+
+typedef std::vector<std::pair<std::string, MetricsValue>> MetricsRecord_t;
+
+inline void addMetric(MetricsRecord_t &record, const std::string &key, const std::string &value) {
+  record.emplace_back(key, MetricsValue{value, false});
+}
+
+inline void addMetric(MetricsRecord_t &record, const std::string &key, const char *value) {
+  addMetric(record, key, std::string(value));
+}
+
+inline void addMetric(MetricsRecord_t &record, const std::string &key, double value) {
+  std::ostringstream ss;
+  ss << std::setprecision(10) << value;
+  // JSON has no representation for NaN and infinity.
+  record.emplace_back(key, MetricsValue{std::isfinite(value) ? ss.str() : "null", true});
+}
+
+template <typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
+inline void addMetric(MetricsRecord_t &record, const std::string &key, T value) {
+  record.emplace_back(key, MetricsValue{std::to_string(value), true});
+}
+
+inline bool parseOutputFormat(const char *arg, EOutputFormat &format) {
+  if (strcmp(arg, "text") == 0) {
+    format = EOutputFormat::kText;
+  } else if (strcmp(arg, "json") == 0) {
+    format = EOutputFormat::kJSON;
+  } else if (strcmp(arg, "csv") == 0) {
+    format = EOutputFormat::kCSV;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+inline std::string escapeJSON(const std::string &str) {
+  std::ostringstream ss;
+  for (const char c : str) {
+    switch (c) {
+    case '"':
+      ss << "\\\"";
+      break;
+    case '\\':
+      ss << "\\\\";
+      break;
+    case '\n':
+      ss << "\\n";
+      break;
+    case '\t':
+      ss << "\\t";
+      break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20) {
+        ss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c);
+      } else {
+        ss << c;
+      }
+    }
+  }
+  return ss.str();
+}
+
+inline std::string escapeCSV(const std::string &str) {
+  if (str.find_first_of(",\"\n") == std::string::npos)
+    return str;
+
+  std::string escaped = "\"";
+  for (const char c : str) {
+    if (c == '"')
+      escaped += '"';
+    escaped += c;
+  }
+  return escaped + "\"";
+}
+
+inline void writeJSON(std::ostream &output, const std::vector<MetricsRecord_t> &records) {
+  output << "[";
+  for (std::size_t i = 0; i < records.size(); ++i) {
+    output << (i == 0 ? "\n  {" : ",\n  {");
+    for (std::size_t j = 0; j < records[i].size(); ++j) {
+      const auto &[key, val] = records[i][j];
+      output << (j == 0 ? "" : ", ") << "\"" << escapeJSON(key) << "\": ";
+      if (val.isNumeric)
+        output << val.value;
+      else
+        output << "\"" << escapeJSON(val.value) << "\"";
+    }
+    output << "}";
+  }
+  output << "\n]" << std::endl;
+}
+
+// Records do not necessarily have the same keys (e.g. when a counter is only available for one of
+// the formats), so the header consists of all keys in the order in which they first appear.
+inline void writeCSV(std::ostream &output, const std::vector<MetricsRecord_t> &records) {
+  std::vector<std::string> header;
+  for (const auto &record : records) {
+    for (const auto &[key, _] : record) {
+      if (std::find(header.begin(), header.end(), key) == header.end())
+        header.emplace_back(key);
+    }
+  }
+
+  for (std::size_t i = 0; i < header.size(); ++i) {
+    output << (i == 0 ? "" : ",") << escapeCSV(header[i]);
+  }
+  output << std::endl;
+
+  for (const auto &record : records) {
+    for (std::size_t i = 0; i < header.size(); ++i) {
+      auto it = std::find_if(record.begin(), record.end(),
+                             [&](const auto &field) { return field.first == header[i]; });
+      output << (i == 0 ? "" : ",");
+      if (it != record.end() && !(it->second.isNumeric && it->second.value == "null"))
+        output << escapeCSV(it->second.value);
+    }
+    output << std::endl;
+  }
+}
+
+inline void writeRecords(std::ostream &output, const std::vector<MetricsRecord_t> &records,
+                         EOutputFormat format) {
+  if (format == EOutputFormat::kJSON)
+    writeJSON(output, records);
+  else if (format == EOutputFormat::kCSV)
+    writeCSV(output, records);
+}
+
+#endif // ATLAS_BM_OUTPUT_H
@@ -0,0 +1,65 @@
+#ifndef ATLAS_BM_TREE_H
+#define ATLAS_BM_TREE_H
+
+#include <TBranch.h>
+#include <TFile.h>
+#include <TLeaf.h>
+#include <TTree.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+
+// Basket sizes of a written tree. The size requested with TTree::SetBasketSize is only the initial
+// basket buffer size: at the first auto-flush, TTree::OptimizeBaskets resizes the buffers of all
+// branches, so the effective sizes have to be read back from the output file.
+struct BasketSizeStats {
+  // Basket buffer sizes of the branches, in bytes
+  Int_t minBufferSize = 0;
+  Int_t maxBufferSize = 0;
+  double meanBufferSize = 0.;
+  // Average uncompressed size of the written baskets, in bytes
+  double meanBasketBytes = 0.;
+};
+
+inline BasketSizeStats getBasketSizeStats(TTree &tree) {
+  BasketSizeStats stats;
+  std::size_t nBranches = 0;
+  Long64_t totBytes = 0;
+  Long64_t nBaskets = 0;
+
+  // Branches with several leaves are counted once, through their first leaf.
+  auto leaves = tree.GetListOfLeaves();
+  for (int i = 0; i < leaves->GetEntries(); ++i) {
+    auto leaf = static_cast<TLeaf *>(leaves->At(i));
+    auto branch = leaf->GetBranch();
+    if (branch->GetListOfLeaves()->At(0) != leaf)
+      continue;
+    const auto bufferSize = branch->GetBasketSize();
+    stats.minBufferSize = nBranches == 0 ? bufferSize : std::min(stats.minBufferSize, bufferSize);
+    stats.maxBufferSize = std::max(stats.maxBufferSize, bufferSize);
+    stats.meanBufferSize += bufferSize;
+    totBytes += branch->GetTotBytes();
+    nBaskets += branch->GetWriteBasket();
+    ++nBranches;
+  }
+
+  if (nBranches > 0)
+    stats.meanBufferSize /= nBranches;
+  if (nBaskets > 0)
+    stats.meanBasketBytes = static_cast<double>(totBytes) / nBaskets;
+  return stats;
+}
+
+// Returns the basket sizes of the tree in the given file, or all zeros if it cannot be read.
+inline BasketSizeStats getBasketSizeStats(const std::string &path, const std::string &treeName) {
+  auto file = std::unique_ptr<TFile>(TFile::Open(path.c_str(), "READ"));
+  if (!file || file->IsZombie())
+    return {};
+  auto tree = file->Get<TTree>(treeName.c_str());
+  if (!tree)
+    return {};
+  return getBasketSizeStats(*tree);
+}
+
+#endif // ATLAS_BM_TREE_H
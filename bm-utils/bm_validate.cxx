@@ -0,0 +1,640 @@
+#include <ROOT/RNTuple.hxx>
+#include <ROOT/RNTupleView.hxx>
+
+#include <TBranch.h>
+#include <TFile.h>
+#include <TROOT.h>
+#include <TTree.h>
+#include <TTreeReader.h>
+#include <TTreeReaderValue.h>
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <regex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "bm-utils/bm_ntuple_compat.hxx"
+#include "bm-utils/bm_options.hxx"
+#include "bm-utils/bm_output.hxx"
+
+using ROOT::Experimental::NTupleSize_t;
+using ROOT::Experimental::RNTupleReader;
+using ROOT::Experimental::RNTupleView;
+
+// Validation of a converted file: checks that every branch of a TTree has a corresponding field in
+// an RNTuple (and vice versa), and that their values are identical. The columns are divided into
+// groups which are validated in parallel, each in a single pass over both files. Columns are
+// compared either entry by entry, or by a checksum per RNTuple cluster.
+//
+// Only columns of fundamental types, std::string and (nested) std::vectors thereof are compared;
+// columns of other types (e.g. xAOD classes) are reported as unsupported.
+
+enum class EValidationMode { kEntry, kChecksum };
+
+struct ValidateConfig {
+  std::string treePath;
+  std::string ntuplePath;
+  std::string treeName = "CollectionTree";
+  std::string ntupleName; // same as the tree name by default
+  std::regex columnRegex{".*"};
+  EValidationMode mode = EValidationMode::kEntry;
+  unsigned nThreads = 1;
+  EOutputFormat outputFormat = EOutputFormat::kText;
+};
+
+// Only identical columns and columns with a type that cannot be compared (kUnsupported) pass the
+// validation. A branch whose type does not match the type of its field (kTypeMismatch), or a field
+// that cannot be read (kError), fails it.
+enum class EColumnStatus {
+  kIdentical,
+  kMismatch,
+  kTypeMismatch,
+  kError,
+  kUnsupported,
+  kNoField,
+  kNoBranch
+};
+
+struct ColumnResult {
+  std::string branchName;
+  std::string fieldName;
+  std::string typeName;
+  EColumnStatus status = EColumnStatus::kIdentical;
+  std::uint64_t nMismatches = 0; // entries or clusters, depending on the mode
+  std::int64_t firstMismatch = -1;
+  std::string error; // for kError
+};
+
+struct EntryRange {
+  NTupleSize_t first;
+  NTupleSize_t nEntries;
+};
+
+// Branch and field names
+
+bool replaceSubstr(std::string &str, std::string_view from, std::string_view to) {
+  size_t startPos = str.find(from);
+  if (startPos == std::string::npos)
+    return false;
+  str.replace(startPos, from.length(), to);
+  return true;
+}
+
+// Returns the possible field names of a branch: with the dots converted to underscores (as by
+// bm_convert and gen_daod_phys, e.g. ElectronsAuxDyn.pt -> ElectronsAuxDyn_pt), or with the ATLAS
+// naming of the first RNTuple DAODs (e.g. ElectronsAuxDyn.pt -> ElectronsAux::pt).
+std::vector<std::string> getFieldNames(std::string branchName) {
+  branchName.erase(branchName.find_last_not_of('.') + 1);
+
+  std::string fieldName = branchName;
+  std::replace(fieldName.begin(), fieldName.end(), '.', '_');
+
+  std::string atlasFieldName = branchName;
+  replaceSubstr(atlasFieldName, "Dyn", ":");
+  std::replace(atlasFieldName.begin(), atlasFieldName.end(), '.', ':');
+
+  return {fieldName, atlasFieldName};
+}
+
+// Value comparison
+
+// 64-bit FNV-1a hash.
+constexpr std::uint64_t kHashSeed = 14695981039346656037ULL;
+
+void hashBytes(std::uint64_t &hash, const void *data, std::size_t size) {
+  const auto bytes = static_cast<const unsigned char *>(data);
+  for (std::size_t i = 0; i < size; ++i) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+  }
+}
+
+template <typename T> void hashValue(std::uint64_t &hash, const T &value) {
+  static_assert(std::is_arithmetic_v<T>);
+  hashBytes(hash, &value, sizeof(T));
+}
+
+void hashValue(std::uint64_t &hash, const std::string &value) {
+  const std::uint64_t size = value.size();
+  hashBytes(hash, &size, sizeof(size));
+  hashBytes(hash, value.data(), value.size());
+}
+
+template <typename T> void hashValue(std::uint64_t &hash, const std::vector<T> &value) {
+  const std::uint64_t size = value.size();
+  hashBytes(hash, &size, sizeof(size));
+  for (const auto &item : value) {
+    hashValue(hash, item);
+  }
+}
+
+// Values are compared bitwise, so that NaNs compare equal and -0 and +0 do not.
+template <typename T> bool isIdentical(const T &a, const T &b) {
+  static_assert(std::is_arithmetic_v<T>);
+  return std::memcmp(&a, &b, sizeof(T)) == 0;
+}
+
+bool isIdentical(const std::string &a, const std::string &b) { return a == b; }
+
+template <typename T> bool isIdentical(const std::vector<T> &a, const std::vector<T> &b) {
+  if (a.size() != b.size())
+    return false;
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    if (!isIdentical(a[i], b[i]))
+      return false;
+  }
+  return true;
+}
+
+class ColumnValidator {
+public:
+  virtual ~ColumnValidator() = default;
+  // Whether the TTree reader could be set up for the branch. Only valid after reading an entry.
+  virtual bool isTreeValueValid() const = 0;
+  virtual bool compare(NTupleSize_t entry) = 0;
+  virtual void hashTreeValue(std::uint64_t &hash) = 0;
+  virtual void hashNTupleValue(NTupleSize_t entry, std::uint64_t &hash) = 0;
+};
+
+template <typename T> class TypedColumnValidator : public ColumnValidator {
+  TTreeReaderValue<T> fTreeValue;
+  RNTupleView<T> fNTupleView;
+
+public:
+  TypedColumnValidator(TTreeReader &treeReader, RNTupleReader &ntupleReader,
+                       const ColumnResult &column)
+      : fTreeValue(treeReader, column.branchName.c_str()),
+        fNTupleView(ntupleReader.GetView<T>(column.fieldName)) {}
+
+  bool isTreeValueValid() const final { return fTreeValue.GetSetupStatus() >= 0; }
+  bool compare(NTupleSize_t entry) final { return isIdentical(*fTreeValue, fNTupleView(entry)); }
+  void hashTreeValue(std::uint64_t &hash) final { hashValue(hash, *fTreeValue); }
+  void hashNTupleValue(NTupleSize_t entry, std::uint64_t &hash) final {
+    hashValue(hash, fNTupleView(entry));
+  }
+};
+
+template <typename T> struct TypeTag {
+  using type = T;
+};
+
+template <typename F> bool dispatchScalarType(const std::string &typeName, F &&f) {
+  if (typeName == "bool")
+    f(TypeTag<bool>{});
+  else if (typeName == "char")
+    f(TypeTag<char>{});
+  else if (typeName == "std::int8_t")
+    f(TypeTag<std::int8_t>{});
+  else if (typeName == "std::uint8_t")
+    f(TypeTag<std::uint8_t>{});
+  else if (typeName == "std::int16_t")
+    f(TypeTag<std::int16_t>{});
+  else if (typeName == "std::uint16_t")
+    f(TypeTag<std::uint16_t>{});
+  else if (typeName == "std::int32_t")
+    f(TypeTag<std::int32_t>{});
+  else if (typeName == "std::uint32_t")
+    f(TypeTag<std::uint32_t>{});
+  else if (typeName == "std::int64_t")
+    f(TypeTag<std::int64_t>{});
+  else if (typeName == "std::uint64_t")
+    f(TypeTag<std::uint64_t>{});
+  else if (typeName == "float")
+    f(TypeTag<float>{});
+  else if (typeName == "double")
+    f(TypeTag<double>{});
+  else if (typeName == "std::string")
+    f(TypeTag<std::string>{});
+  else
+    return false;
+  return true;
+}
+
+// Calls f(TypeTag<T>) for the C++ type T corresponding to the RNTuple type name, if supported.
+template <typename F> bool dispatchType(const std::string &typeName, F &&f) {
+  static const std::regex vectorRegex(R"(std::vector<(.+)>)");
+
+  std::smatch match;
+  if (!std::regex_match(typeName, match, vectorRegex))
+    return dispatchScalarType(typeName, f);
+
+  const std::string itemTypeName = match[1];
+  if (!std::regex_match(itemTypeName, match, vectorRegex)) {
+    return dispatchScalarType(itemTypeName, [&](auto tag) {
+      using Item_t = typename decltype(tag)::type;
+      f(TypeTag<std::vector<Item_t>>{});
+    });
+  }
+
+  return dispatchScalarType(match[1], [&](auto tag) {
+    using Item_t = typename decltype(tag)::type;
+    f(TypeTag<std::vector<std::vector<Item_t>>>{});
+  });
+}
+
+bool isSupportedType(const std::string &typeName) {
+  return dispatchType(typeName, [](auto) {});
+}
+
+std::unique_ptr<ColumnValidator> createValidator(TTreeReader &treeReader,
+                                                 RNTupleReader &ntupleReader,
+                                                 const ColumnResult &column) {
+  std::unique_ptr<ColumnValidator> validator;
+  dispatchType(column.typeName, [&](auto tag) {
+    using Value_t = typename decltype(tag)::type;
+    validator = std::make_unique<TypedColumnValidator<Value_t>>(treeReader, ntupleReader, column);
+  });
+  return validator;
+}
+
+// Validation
+
+// Matches the branches of the tree with the fields of the RNTuple. Columns that are only present
+// in one of the two, or that have an unsupported type, are marked as such.
+std::vector<ColumnResult> matchColumns(const ValidateConfig &config, TTree &tree,
+                                       RNTupleReader &ntupleReader) {
+  const auto descriptor = ntupleReader.GetDescriptor();
+
+  std::vector<ColumnResult> columns;
+  std::vector<std::string> matchedFieldNames;
+  for (auto branch : TRangeDynCast<TBranch>(tree.GetListOfBranches())) {
+    if (!branch || !std::regex_match(branch->GetName(), config.columnRegex))
+      continue;
+
+    ColumnResult column;
+    column.branchName = branch->GetName();
+    column.status = EColumnStatus::kNoField;
+    for (const auto &fieldName : getFieldNames(column.branchName)) {
+      const auto fieldId = descriptor->FindFieldId(fieldName);
+      if (fieldId == ROOT::Experimental::kInvalidDescriptorId)
+        continue;
+
+      column.fieldName = fieldName;
+      column.typeName = descriptor->GetFieldDescriptor(fieldId).GetTypeName();
+      if (!isSupportedType(column.typeName))
+        column.status = EColumnStatus::kUnsupported;
+      else
+        column.status = EColumnStatus::kIdentical;
+      matchedFieldNames.emplace_back(fieldName);
+      break;
+    }
+    columns.emplace_back(std::move(column));
+  }
+
+  for (const auto &field : descriptor->GetTopLevelFields()) {
+    if (!std::regex_match(field.GetFieldName(), config.columnRegex) ||
+        std::find(matchedFieldNames.begin(), matchedFieldNames.end(), field.GetFieldName()) !=
+            matchedFieldNames.end()) {
+      continue;
+    }
+    ColumnResult column;
+    column.fieldName = field.GetFieldName();
+    column.typeName = field.GetTypeName();
+    column.status = EColumnStatus::kNoBranch;
+    columns.emplace_back(std::move(column));
+  }
+
+  return columns;
+}
+
+std::vector<EntryRange> getClusterRanges(RNTupleReader &ntupleReader) {
+  std::vector<EntryRange> ranges;
+  for (const auto &cluster : ntupleReader.GetDescriptor()->GetClusterIterable()) {
+    ranges.emplace_back(EntryRange{cluster.GetFirstEntryIndex(), cluster.GetNEntries()});
+  }
+  std::sort(ranges.begin(), ranges.end(),
+            [](const auto &a, const auto &b) { return a.first < b.first; });
+  return ranges;
+}
+
+void recordMismatch(ColumnResult &column, std::int64_t index) {
+  column.status = EColumnStatus::kMismatch;
+  if (column.nMismatches++ == 0)
+    column.firstMismatch = index;
+}
+
+// Validates a group of columns in a single pass over both files. Each group opens its own readers,
+// so groups can be validated in parallel.
+void validateGroup(const ValidateConfig &config, const std::vector<EntryRange> &clusterRanges,
+                   std::vector<ColumnResult *> &group) {
+  auto file = std::unique_ptr<TFile>(TFile::Open(config.treePath.c_str()));
+  auto tree = file->Get<TTree>(config.treeName.c_str());
+  auto ntupleReader = RNTupleReader::Open(config.ntupleName, config.ntuplePath);
+  const auto nEntries = ntupleReader->GetNEntries();
+
+  // TTreeReader does not read any entry if one of its values could not be set up (i.e. because
+  // the type of the branch does not match that of the field), so such columns are marked as type
+  // mismatches and the reader is set up again without them until all its values are valid.
+  std::unique_ptr<TTreeReader> treeReader;
+  std::vector<std::unique_ptr<ColumnValidator>> validators;
+  bool isSetUp = false;
+  while (!isSetUp) {
+    validators.clear();
+    treeReader = std::make_unique<TTreeReader>(tree);
+
+    for (auto column : group) {
+      if (column->status != EColumnStatus::kIdentical) {
+        validators.emplace_back(nullptr);
+        continue;
+      }
+      try {
+        validators.emplace_back(createValidator(*treeReader, *ntupleReader, *column));
+      } catch (const std::exception &e) {
+        column->status = EColumnStatus::kError;
+        column->error = e.what();
+        validators.emplace_back(nullptr);
+      }
+    }
+
+    isSetUp = true;
+    if (nEntries == 0)
+      break;
+    treeReader->SetEntry(0);
+    for (std::size_t c = 0; c < validators.size(); ++c) {
+      if (validators[c] && !validators[c]->isTreeValueValid()) {
+        group[c]->status = EColumnStatus::kTypeMismatch;
+        isSetUp = false;
+      }
+    }
+  }
+
+  std::vector<std::uint64_t> treeHashes(validators.size(), kHashSeed);
+  std::vector<std::uint64_t> ntupleHashes(validators.size(), kHashSeed);
+  std::size_t clusterIndex = 0;
+
+  for (NTupleSize_t i = 0; i < nEntries; ++i) {
+    treeReader->SetEntry(i);
+
+    for (std::size_t c = 0; c < validators.size(); ++c) {
+      auto &validator = validators[c];
+      if (!validator)
+        continue;
+
+      if (config.mode == EValidationMode::kEntry) {
+        if (!validator->compare(i))
+          recordMismatch(*group[c], i);
+      } else {
+        validator->hashTreeValue(treeHashes[c]);
+        validator->hashNTupleValue(i, ntupleHashes[c]);
+      }
+    }
+
+    // At the end of a cluster, compare and reset the checksums.
+    const auto &cluster = clusterRanges[clusterIndex];
+    if (config.mode == EValidationMode::kChecksum && i + 1 == cluster.first + cluster.nEntries) {
+      for (std::size_t c = 0; c < validators.size(); ++c) {
+        if (validators[c] && treeHashes[c] != ntupleHashes[c])
+          recordMismatch(*group[c], cluster.first);
+        treeHashes[c] = ntupleHashes[c] = kHashSeed;
+      }
+      ++clusterIndex;
+    }
+  }
+}
+
+void validateColumns(const ValidateConfig &config, const std::vector<EntryRange> &clusterRanges,
+                     std::vector<ColumnResult> &columns) {
+  std::vector<ColumnResult *> toValidate;
+  for (auto &column : columns) {
+    if (column.status == EColumnStatus::kIdentical)
+      toValidate.emplace_back(&column);
+  }
+
+  // Multiple groups per thread, to balance columns of different sizes.
+  const std::size_t nGroups =
+      std::min<std::size_t>(toValidate.size(), 2 * static_cast<std::size_t>(config.nThreads));
+  std::vector<std::vector<ColumnResult *>> groups(nGroups);
+  for (std::size_t i = 0; i < toValidate.size(); ++i) {
+    groups[i % nGroups].emplace_back(toValidate[i]);
+  }
+
+  std::atomic<std::size_t> nextGroup{0};
+  std::vector<std::thread> threads;
+  for (std::size_t t = 0; t < std::min<std::size_t>(config.nThreads, nGroups); ++t) {
+    threads.emplace_back([&]() {
+      for (auto g = nextGroup++; g < groups.size(); g = nextGroup++) {
+        validateGroup(config, clusterRanges, groups[g]);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+// Output
+
+std::string getStatusName(EColumnStatus status) {
+  switch (status) {
+  case EColumnStatus::kIdentical:
+    return "identical";
+  case EColumnStatus::kMismatch:
+    return "mismatch";
+  case EColumnStatus::kTypeMismatch:
+    return "type_mismatch";
+  case EColumnStatus::kError:
+    return "error";
+  case EColumnStatus::kUnsupported:
+    return "unsupported";
+  case EColumnStatus::kNoField:
+    return "no_field";
+  default:
+    return "no_branch";
+  }
+}
+
+void printResults(const ValidateConfig &config, const std::vector<ColumnResult> &columns) {
+  const auto unit = config.mode == EValidationMode::kEntry ? "entries" : "clusters";
+
+  std::vector<std::size_t> nPerStatus(7);
+  for (const auto &column : columns) {
+    nPerStatus[static_cast<std::size_t>(column.status)]++;
+
+    switch (column.status) {
+    case EColumnStatus::kMismatch:
+      std::cout << "mismatch: " << column.branchName << " <-> " << column.fieldName << " ("
+                << column.nMismatches << " " << unit << ", first at entry "
+                << column.firstMismatch << ")" << std::endl;
+      break;
+    case EColumnStatus::kTypeMismatch:
+      std::cout << "type mismatch: " << column.branchName << " <-> " << column.fieldName
+                << " (branch cannot be read as " << column.typeName << ")" << std::endl;
+      break;
+    case EColumnStatus::kError:
+      std::cout << "error: " << column.branchName << " <-> " << column.fieldName << " ("
+                << column.error << ")" << std::endl;
+      break;
+    case EColumnStatus::kUnsupported:
+      std::cout << "not compared: " << column.branchName << " <-> " << column.fieldName << " ("
+                << column.typeName << ")" << std::endl;
+      break;
+    case EColumnStatus::kNoField:
+      std::cout << "no field for branch " << column.branchName << std::endl;
+      break;
+    case EColumnStatus::kNoBranch:
+      std::cout << "no branch for field " << column.fieldName << std::endl;
+      break;
+    default:
+      break;
+    }
+  }
+
+  std::cout << "identical\tmismatch\ttype_mismatch\terror\tunsupported\tno_field\tno_branch"
+            << std::endl;
+  for (std::size_t i = 0; i < nPerStatus.size(); ++i) {
+    std::cout << (i == 0 ? "" : "\t") << nPerStatus[i];
+  }
+  std::cout << std::endl;
+}
+
+std::vector<MetricsRecord_t> getRecords(const ValidateConfig &config,
+                                        const std::vector<ColumnResult> &columns) {
+  std::vector<MetricsRecord_t> records;
+  for (const auto &column : columns) {
+    MetricsRecord_t record;
+    addMetric(record, "tree_file", config.treePath);
+    addMetric(record, "ntuple_file", config.ntuplePath);
+    addMetric(record, "mode", config.mode == EValidationMode::kEntry ? "entry" : "checksum");
+    addMetric(record, "branch", column.branchName);
+    addMetric(record, "field", column.fieldName);
+    addMetric(record, "type", column.typeName);
+    addMetric(record, "status", getStatusName(column.status));
+    addMetric(record, "mismatches", column.nMismatches);
+    addMetric(record, "first_mismatch", column.firstMismatch);
+    records.emplace_back(std::move(record));
+  }
+  return records;
+}
+
+static void printUsage(std::string_view prog) {
+  std::cout << "USAGE: " << prog
+            << " (-h|-t TTREE_PATH -r RNTUPLE_PATH [-n TREE_NAME] [-N NTUPLE_NAME] "
+               "[-m (entry|checksum)] [-x COLUMN_REGEX] [-j N_THREADS] [-o (text|json|csv)])"
+            << std::endl;
+}
+
+int main(int argc, char **argv) {
+  // Suppress (irrelevant) warnings
+  gErrorIgnoreLevel = kError;
+
+  ValidateConfig config;
+
+  int c;
+  while ((c = getopt(argc, argv, "ht:r:n:N:m:x:j:o:")) != -1) {
+    switch (c) {
+    case 'h':
+      printUsage(argv[0]);
+      return 0;
+    case 't':
+      config.treePath = optarg;
+      break;
+    case 'r':
+      config.ntuplePath = optarg;
+      break;
+    case 'n':
+      config.treeName = optarg;
+      break;
+    case 'N':
+      config.ntupleName = optarg;
+      break;
+    case 'm':
+      if (strcmp(optarg, "entry") == 0) {
+        config.mode = EValidationMode::kEntry;
+      } else if (strcmp(optarg, "checksum") == 0) {
+        config.mode = EValidationMode::kChecksum;
+      } else {
+        std::cerr << "ERROR: Unknown validation mode " << optarg << std::endl;
+        return 1;
+      }
+      break;
+    case 'x':
+      config.columnRegex = std::regex(optarg);
+      break;
+    case 'j':
+      if (!parseUnsigned(optarg, config.nThreads)) {
+        std::cerr << "ERROR: invalid number of threads " << optarg << std::endl;
+        return 1;
+      }
+      if (config.nThreads < 1) {
+        std::cerr << "ERROR: the number of threads must be at least 1" << std::endl;
+        return 1;
+      }
+      break;
+    case 'o':
+      if (!parseOutputFormat(optarg, config.outputFormat)) {
+        std::cerr << "ERROR: Unknown output format " << optarg << std::endl;
+        return 1;
+      }
+      break;
+    default:
+      printUsage(argv[0]);
+      return 1;
+    }
+  }
+
+  if (config.treePath.empty() || config.ntuplePath.empty()) {
+    std::cerr << "ERROR: please provide both a TTree and an RNTuple input path\n" << std::endl;
+    printUsage(argv[0]);
+    return 1;
+  }
+  if (config.ntupleName.empty())
+    config.ntupleName = config.treeName;
+
+  if (config.nThreads > 1)
+    ROOT::EnableThreadSafety();
+
+  auto file = std::unique_ptr<TFile>(TFile::Open(config.treePath.c_str()));
+  if (!file || file->IsZombie()) {
+    std::cerr << "ERROR: could not open " << config.treePath << std::endl;
+    return 1;
+  }
+  auto tree = file->Get<TTree>(config.treeName.c_str());
+  if (!tree) {
+    std::cerr << "ERROR: could not find tree " << config.treeName << " in " << config.treePath
+              << std::endl;
+    return 1;
+  }
+  auto ntupleReader = RNTupleReader::Open(config.ntupleName, config.ntuplePath);
+
+  if (static_cast<std::uint64_t>(tree->GetEntries()) != ntupleReader->GetNEntries()) {
+    std::cerr << "ERROR: the tree has " << tree->GetEntries() << " entries, the RNTuple "
+              << ntupleReader->GetNEntries() << std::endl;
+    return 1;
+  }
+
+  auto columns = matchColumns(config, *tree, *ntupleReader);
+  validateColumns(config, getClusterRanges(*ntupleReader), columns);
+
+  if (config.outputFormat == EOutputFormat::kText)
+    printResults(config, columns);
+  else
+    writeRecords(std::cout, getRecords(config, columns), config.outputFormat);
+
+  const bool isValid = std::all_of(columns.begin(), columns.end(), [](const auto &column) {
+    return column.status == EColumnStatus::kIdentical ||
+           column.status == EColumnStatus::kUnsupported;
+  });
+  const auto nUnsupported =
+      std::count_if(columns.begin(), columns.end(), [](const auto &column) {
+        return column.status == EColumnStatus::kUnsupported;
+      });
+  if (nUnsupported > 0) {
+    std::cerr << "WARNING: " << nUnsupported << " of " << columns.size()
+              << " columns have a type that cannot be compared and were not validated"
+              << std::endl;
+  }
+  if (!isValid) {
+    std::cerr << "ERROR: validation failed" << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
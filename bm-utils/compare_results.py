@@ -0,0 +1,215 @@
+"""Comparison of a benchmark run of bm_regression.sh against a baseline run.
+
+Reads the CSV results of bm_readspeed and bm_size from the two run directories and matches the
+records by their configuration (format, sample, compression, medium, workload and thread count;
+the sizes have no workload).
+The event loop wall times of each configuration are compared with a one-sided Mann-Whitney U test,
+and a configuration is flagged as a regression if the wall times of the run are significantly
+larger than those of the baseline and the median has increased by more than the given threshold.
+Since the sizes do not vary between runs, they are flagged as a regression if they have increased
+by more than the size threshold. Configurations of the baseline that are missing from the run (e.g.
+because the benchmark crashed) are flagged as well.
+
+Exits with 1 if any regressions or missing configurations are found, so it can be used to fail a CI
+job.
+"""
+
+from argparse import ArgumentParser
+from typing import Dict, List, Tuple
+
+import csv
+import glob
+import math
+import os
+import statistics
+import sys
+
+READSPEED_KEY = ("format", "sample", "compression", "medium", "workload", "threads")
+SIZE_KEY = ("format", "sample", "compression", "medium", "threads")
+
+
+def read_run_info(run_dir: str) -> Dict[str, str]:
+    path = os.path.join(run_dir, "run_info.csv")
+    if not os.path.exists(path):
+        return {}
+    with open(path, "r") as f:
+        return {row["key"]: row["value"] for row in csv.DictReader(f)}
+
+
+def read_records(run_dir: str, prefix: str) -> List[Dict[str, str]]:
+    records = []
+    for path in sorted(glob.glob(os.path.join(run_dir, f"{prefix}_*.csv"))):
+        with open(path, "r") as f:
+            records.extend(csv.DictReader(f))
+    return records
+
+
+def get_wall_times(run_dir: str) -> Dict[Tuple[str, ...], List[float]]:
+    wall_times: Dict[Tuple[str, ...], List[float]] = {}
+    for record in read_records(run_dir, "readspeed"):
+        if record.get("record") != "event_loop":
+            continue
+        key = tuple(record.get(k, "") for k in READSPEED_KEY)
+        wall_times.setdefault(key, []).append(float(record["wall_time_s"]))
+    return wall_times
+
+
+def get_sizes(run_dir: str) -> Dict[Tuple[str, ...], float]:
+    return {
+        tuple(record.get(k, "") for k in SIZE_KEY): float(record["compressed_bytes"])
+        for record in read_records(run_dir, "size")
+    }
+
+
+def mann_whitney_p(baseline: List[float], current: List[float]) -> float:
+    """One-sided p-value of the hypothesis that the current values are not larger than the baseline
+    values, using the normal approximation of the U statistic (with tie correction)."""
+    n1, n2 = len(baseline), len(current)
+    values = sorted([(v, 0) for v in baseline] + [(v, 1) for v in current])
+
+    # Assign average ranks to ties.
+    ranks = [0.0] * len(values)
+    tie_term = 0.0
+    i = 0
+    while i < len(values):
+        j = i
+        while j + 1 < len(values) and values[j + 1][0] == values[i][0]:
+            j += 1
+        for k in range(i, j + 1):
+            ranks[k] = (i + j) / 2 + 1
+        n_tied = j - i + 1
+        tie_term += n_tied**3 - n_tied
+        i = j + 1
+
+    rank_sum = sum(r for r, (_, group) in zip(ranks, values) if group == 1)
+    u = rank_sum - n2 * (n2 + 1) / 2
+    n = n1 + n2
+    variance = n1 * n2 / 12 * ((n + 1) - tie_term / (n * (n - 1)))
+    if variance <= 0:
+        return 1.0
+
+    # Continuity correction.
+    z = (u - n1 * n2 / 2 - 0.5) / math.sqrt(variance)
+    return 0.5 * math.erfc(z / math.sqrt(2))
+
+
+def compare_readspeed(
+    baseline_dir: str, run_dir: str, alpha: float, threshold: float
+) -> Tuple[List[Tuple], int]:
+    baseline = get_wall_times(baseline_dir)
+    current = get_wall_times(run_dir)
+
+    rows = []
+    n_regressions = 0
+    for key in sorted(current.keys() & baseline.keys()):
+        base_median = statistics.median(baseline[key])
+        cur_median = statistics.median(current[key])
+        change = cur_median / base_median - 1
+        p = mann_whitney_p(baseline[key], current[key])
+        # Improvements are tested with the groups swapped.
+        p_improvement = mann_whitney_p(current[key], baseline[key])
+
+        if p < alpha and change > threshold:
+            status = "REGRESSION"
+            n_regressions += 1
+        elif p_improvement < alpha and -change > threshold:
+            status = "improvement"
+        else:
+            status = "ok"
+        rows.append((*key, base_median, cur_median, change, min(p, p_improvement), status))
+
+    for key in sorted(baseline.keys() - current.keys()):
+        base_median = statistics.median(baseline[key])
+        rows.append((*key, base_median, math.nan, math.nan, math.nan, "MISSING"))
+        n_regressions += 1
+
+    for key in sorted(current.keys() - baseline.keys()):
+        print(f"Not in baseline: {', '.join(key)}", file=sys.stderr)
+
+    return rows, n_regressions
+
+
+def compare_size(baseline_dir: str, run_dir: str, threshold: float) -> Tuple[List[Tuple], int]:
+    baseline = get_sizes(baseline_dir)
+    current = get_sizes(run_dir)
+
+    rows = []
+    n_regressions = 0
+    for key in sorted(current.keys() & baseline.keys()):
+        change = current[key] / baseline[key] - 1
+        if change > threshold:
+            status = "REGRESSION"
+            n_regressions += 1
+        elif -change > threshold:
+            status = "improvement"
+        else:
+            status = "ok"
+        rows.append((*key, baseline[key], current[key], change, status))
+
+    for key in sorted(baseline.keys() - current.keys()):
+        rows.append((*key, baseline[key], math.nan, math.nan, "MISSING"))
+        n_regressions += 1
+
+    return rows, n_regressions
+
+
+def print_table(header: Tuple[str, ...], rows: List[Tuple]) -> None:
+    print("\t".join(header))
+    for row in rows:
+        print("\t".join(f"{v:.4g}" if isinstance(v, float) else str(v) for v in row))
+
+
+if __name__ == "__main__":
+    parser = ArgumentParser(
+        prog="compare_results.py",
+        description="Flag regressions of a bm_regression.sh run with respect to a baseline run",
+    )
+    parser.add_argument("baseline_dir")
+    parser.add_argument("run_dir")
+    parser.add_argument(
+        "-a", "--alpha", type=float, default=0.01, help="significance level (default: 0.01)"
+    )
+    parser.add_argument(
+        "-t",
+        "--threshold",
+        type=float,
+        default=0.05,
+        help="minimum relative increase of the median wall time (default: 0.05)",
+    )
+    parser.add_argument(
+        "-s",
+        "--size-threshold",
+        type=float,
+        default=0.005,
+        help="minimum relative increase of the compressed size (default: 0.005)",
+    )
+    args = parser.parse_args()
+
+    baseline_info = read_run_info(args.baseline_dir)
+    run_info = read_run_info(args.run_dir)
+    print("info\tbaseline\trun")
+    for key in sorted(baseline_info.keys() | run_info.keys()):
+        print(f"{key}\t{baseline_info.get(key, '')}\t{run_info.get(key, '')}")
+    print()
+
+    readspeed_rows, n_readspeed_regressions = compare_readspeed(
+        args.baseline_dir, args.run_dir, args.alpha, args.threshold
+    )
+    print_table(
+        (*READSPEED_KEY, "baseline_median_s", "median_s", "change", "p", "status"),
+        readspeed_rows,
+    )
+    print()
+
+    size_rows, n_size_regressions = compare_size(
+        args.baseline_dir, args.run_dir, args.size_threshold
+    )
+    print_table((*SIZE_KEY, "baseline_bytes", "bytes", "change", "status"), size_rows)
+    print()
+
+    print(
+        f"Regressions (including missing configurations): {n_readspeed_regressions} in read "
+        f"speed, {n_size_regressions} in size",
+        file=sys.stderr,
+    )
+    sys.exit(1 if n_readspeed_regressions + n_size_regressions > 0 else 0)
@@ -0,0 +1,183 @@
+#include <ROOT/RNTuple.hxx>
+#include <ROOT/RNTupleModel.hxx>
+#include <ROOT/RNTupleOptions.hxx>
+
+#include <TFile.h>
+#include <TROOT.h>
+#include <TTree.h>
+
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bm-utils/bm_daod_phys.hxx"
+#include "bm-utils/bm_options.hxx"
+
+using ROOT::Experimental::REntry;
+using ROOT::Experimental::RNTupleModel;
+using ROOT::Experimental::RNTupleWriteOptions;
+using ROOT::Experimental::RNTupleWriter;
+
+// Generator of synthetic DAOD_PHYS-like TTree and RNTuple files, which can be used as benchmark
+// input when no xAOD dictionaries (and hence no real DAOD_PHYS conversion) are available. The
+// files contain the same branches/fields as read by bm_readspeed, i.e. the kinematics of the
+// containers in bm_daod_phys.hxx, plus a configurable number of additional int, char and nested
+// vector columns. Both files are filled from the same in-memory event, so their content is
+// identical.
+
+struct GeneratorConfig {
+  std::string outputDir = ".";
+  std::uint64_t nEvents = 180000;
+  int compression = 505;
+  bool writeTree = true;
+  bool writeNTuple = true;
+  ExtraColumns extraColumns;
+  unsigned seed = 42;
+};
+
+bool generate(const GeneratorConfig &config) {
+  const auto suffix = ".root~" + std::to_string(config.compression);
+  const auto treePath = config.outputDir + "/DAOD_PHYS.ttree" + suffix;
+  const auto ntuplePath = config.outputDir + "/DAOD_PHYS.rntuple" + suffix;
+
+  std::unique_ptr<TFile> treeFile;
+  TTree *tree = nullptr;
+  if (config.writeTree) {
+    treeFile = std::unique_ptr<TFile>(
+        TFile::Open(treePath.c_str(), "RECREATE", "", config.compression));
+    if (!treeFile || treeFile->IsZombie()) {
+      std::cerr << "ERROR: could not create " << treePath << std::endl;
+      return false;
+    }
+    tree = new TTree("CollectionTree", "CollectionTree");
+  }
+
+  auto event = createEvent(config.extraColumns);
+  if (tree)
+    addBranches(*tree, event);
+
+  std::unique_ptr<RNTupleWriter> writer;
+  std::unique_ptr<REntry> entry;
+  if (config.writeNTuple) {
+    auto model = RNTupleModel::CreateBare();
+    addFields(*model, event);
+    RNTupleWriteOptions writeOptions;
+    writeOptions.SetCompression(config.compression);
+    writer = RNTupleWriter::Recreate(std::move(model), "CollectionTree", ntuplePath, writeOptions);
+    entry = writer->CreateEntry();
+    bindEntry(*entry, event);
+  }
+
+  std::mt19937_64 rng(config.seed);
+  for (std::uint64_t i = 0; i < config.nEvents; ++i) {
+    generateEvent(event, rng);
+    if (tree)
+      tree->Fill();
+    if (writer)
+      writer->Fill(*entry);
+  }
+
+  if (tree) {
+    treeFile->Write();
+    std::cout << "Wrote " << config.nEvents << " events to " << treePath << std::endl;
+  }
+  if (writer) {
+    // Destroying the writer commits the last cluster and the footer.
+    writer.reset();
+    std::cout << "Wrote " << config.nEvents << " events to " << ntuplePath << std::endl;
+  }
+  return true;
+}
+
+static void printUsage(std::string_view prog) {
+  std::cout << "USAGE: " << prog
+            << " [-h] [-o OUTPUT_DIR] [-e N_EVENTS] [-c COMPRESSION] [-s (ttree|rntuple|both)] "
+               "[-I N_INT_COLUMNS] [-A N_CHAR_COLUMNS] [-V N_NESTED_VECTOR_COLUMNS] [-r SEED]"
+            << std::endl;
+}
+
+int main(int argc, char **argv) {
+  GeneratorConfig config;
+
+  int c;
+  while ((c = getopt(argc, argv, "ho:e:c:s:I:A:V:r:")) != -1) {
+    switch (c) {
+    case 'h':
+      printUsage(argv[0]);
+      return 0;
+    case 'o':
+      config.outputDir = optarg;
+      break;
+    case 'e':
+      if (!parseUnsigned(optarg, config.nEvents)) {
+        std::cerr << "ERROR: invalid number of events " << optarg << std::endl;
+        return 1;
+      }
+      break;
+    case 'c':
+      if (!parseCompression(optarg, config.compression)) {
+        std::cerr << "ERROR: invalid compression setting " << optarg << std::endl;
+        return 1;
+      }
+      break;
+    case 's':
+      if (strcmp(optarg, "ttree") == 0) {
+        config.writeNTuple = false;
+      } else if (strcmp(optarg, "rntuple") == 0) {
+        config.writeTree = false;
+      } else if (strcmp(optarg, "both") != 0) {
+        std::cerr << "ERROR: Unknown storage mode " << optarg << std::endl;
+        return 1;
+      }
+      break;
+    case 'I':
+      if (!parseUnsigned(optarg, config.extraColumns.nIntColumns)) {
+        std::cerr << "ERROR: invalid number of int columns " << optarg << std::endl;
+        return 1;
+      }
+      break;
+    case 'A':
+      if (!parseUnsigned(optarg, config.extraColumns.nCharColumns)) {
+        std::cerr << "ERROR: invalid number of char columns " << optarg << std::endl;
+        return 1;
+      }
+      break;
+    case 'V':
+      if (!parseUnsigned(optarg, config.extraColumns.nNestedColumns)) {
+        std::cerr << "ERROR: invalid number of nested vector columns " << optarg << std::endl;
+        return 1;
+      }
+      break;
+    case 'r':
+      if (!parseUnsigned(optarg, config.seed)) {
+        std::cerr << "ERROR: invalid seed " << optarg << std::endl;
+        return 1;
+      }
+      break;
+    default:
+      printUsage(argv[0]);
+      return 1;
+    }
+  }
+
+  if (config.nEvents == 0) {
+    std::cerr << "ERROR: the number of events must be at least 1" << std::endl;
+    return 1;
+  }
+
+  // RNTupleWriter and std::filesystem report failures (e.g. an unwritable output directory) with
+  // exceptions.
+  try {
+    std::filesystem::create_directories(config.outputDir);
+    if (!generate(config))
+      return 1;
+  } catch (const std::exception &e) {
+    std::cerr << "ERROR: " << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,229 @@
+"""HTTP file server with a configurable round-trip time and bandwidth.
+
+Serves the files in a directory over HTTP/1.1 with support for (multi-)range requests, as used by
+ROOT's HTTP/davix backends for TFile and RNTuple. Every request is delayed by the round-trip time,
+and the response data are sent at no more than the given bandwidth, shared by all connections. This
+emulates remote storage on localhost, to measure how many round trips and how much latency the
+formats can hide.
+
+When the server is stopped, the number of requests, byte ranges and bytes served are printed.
+"""
+
+from argparse import ArgumentParser
+from http.server import SimpleHTTPRequestHandler, ThreadingHTTPServer
+from typing import List, Optional, Tuple
+
+import os
+import re
+import signal
+import sys
+import threading
+import time
+
+CHUNK_SIZE = 64 * 1024
+BOUNDARY = "ATLAS_BM_BYTERANGES"
+
+
+class Throttle:
+    """Limits the total bandwidth of all connections by reserving time slots for each chunk."""
+
+    def __init__(self, bandwidth: float):
+        self.bandwidth = bandwidth  # in bytes/s, 0 means unlimited
+        self.next_free = 0.0
+        self.lock = threading.Lock()
+
+    def wait(self, n_bytes: int):
+        if self.bandwidth <= 0:
+            return
+        with self.lock:
+            start = max(time.monotonic(), self.next_free)
+            self.next_free = start + n_bytes / self.bandwidth
+            end = self.next_free
+        delay = end - time.monotonic()
+        if delay > 0:
+            time.sleep(delay)
+
+
+class Stats:
+    def __init__(self):
+        self.n_requests = 0
+        self.n_ranges = 0
+        self.n_bytes = 0
+        self.lock = threading.Lock()
+
+    def add(self, n_ranges: int, n_bytes: int):
+        with self.lock:
+            self.n_requests += 1
+            self.n_ranges += n_ranges
+            self.n_bytes += n_bytes
+
+    def print(self):
+        print(
+            f"requests: {self.n_requests}, ranges: {self.n_ranges}, "
+            f"bytes: {self.n_bytes}",
+            file=sys.stderr,
+        )
+
+
+def parse_ranges(header: str, size: int) -> Optional[List[Tuple[int, int]]]:
+    """Parses a 'bytes=a-b,c-d,...' header into a list of inclusive (first, last) ranges."""
+    m = re.fullmatch(r"\s*bytes\s*=\s*(.+)", header)
+    if not m:
+        return None
+
+    ranges = []
+    for spec in m.group(1).split(","):
+        spec_m = re.fullmatch(r"\s*(\d*)-(\d*)\s*", spec)
+        # Malformed ranges (e.g. "-" or "a-b") make the whole header unsatisfiable.
+        if not spec_m or spec_m.group(1) == spec_m.group(2) == "":
+            return None
+        first, last = spec_m.groups()
+        if first == "":
+            # Suffix range: the last N bytes, which is unsatisfiable for N = 0
+            n = int(last)
+            if n == 0:
+                continue
+            first, last = max(0, size - n), size - 1
+        else:
+            first = int(first)
+            last = min(int(last), size - 1) if last else size - 1
+        if first > last or first >= size:
+            continue
+        ranges.append((first, last))
+    return ranges or None
+
+
+class LatencyRequestHandler(SimpleHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+    rtt = 0.0
+    throttle = Throttle(0)
+    stats = Stats()
+
+    def log_message(self, format, *args):
+        pass
+
+    def do_HEAD(self):
+        self.handle_request(send_body=False)
+
+    def do_GET(self):
+        self.handle_request(send_body=True)
+
+    def handle_request(self, send_body: bool):
+        time.sleep(self.rtt)
+
+        path = self.translate_path(self.path)
+        if not os.path.isfile(path):
+            self.send_error(404, "File not found")
+            return
+
+        size = os.path.getsize(path)
+        ranges = None
+        if "Range" in self.headers:
+            ranges = parse_ranges(self.headers["Range"], size)
+            if ranges is None:
+                self.send_response(416)
+                self.send_header("Content-Range", f"bytes */{size}")
+                self.send_header("Content-Length", "0")
+                self.end_headers()
+                return
+
+        with open(path, "rb") as f:
+            if ranges is None:
+                self.send_response(200)
+                self.send_header("Content-Type", "application/octet-stream")
+                self.send_header("Content-Length", str(size))
+                self.send_header("Accept-Ranges", "bytes")
+                self.end_headers()
+                if send_body:
+                    self.send_range(f, 0, size - 1)
+                    self.stats.add(1, size)
+            elif len(ranges) == 1:
+                first, last = ranges[0]
+                self.send_response(206)
+                self.send_header("Content-Type", "application/octet-stream")
+                self.send_header("Content-Range", f"bytes {first}-{last}/{size}")
+                self.send_header("Content-Length", str(last - first + 1))
+                self.send_header("Accept-Ranges", "bytes")
+                self.end_headers()
+                if send_body:
+                    self.send_range(f, first, last)
+                    self.stats.add(1, last - first + 1)
+            else:
+                self.send_multipart(f, ranges, size, send_body)
+
+    def send_multipart(self, f, ranges: List[Tuple[int, int]], size: int, send_body: bool):
+        part_headers = [
+            (
+                f"--{BOUNDARY}\r\nContent-Type: application/octet-stream\r\n"
+                f"Content-Range: bytes {first}-{last}/{size}\r\n\r\n"
+            ).encode()
+            for first, last in ranges
+        ]
+        trailer = f"--{BOUNDARY}--\r\n".encode()
+        length = len(trailer) + sum(
+            len(h) + (last - first + 1) + 2 for h, (first, last) in zip(part_headers, ranges)
+        )
+
+        self.send_response(206)
+        self.send_header("Content-Type", f"multipart/byteranges; boundary={BOUNDARY}")
+        self.send_header("Content-Length", str(length))
+        self.send_header("Accept-Ranges", "bytes")
+        self.end_headers()
+        if not send_body:
+            return
+
+        for header, (first, last) in zip(part_headers, ranges):
+            self.wfile.write(header)
+            self.send_range(f, first, last)
+            self.wfile.write(b"\r\n")
+        self.wfile.write(trailer)
+        self.stats.add(len(ranges), sum(last - first + 1 for first, last in ranges))
+
+    def send_range(self, f, first: int, last: int):
+        f.seek(first)
+        remaining = last - first + 1
+        while remaining > 0:
+            chunk = f.read(min(CHUNK_SIZE, remaining))
+            if not chunk:
+                break
+            self.throttle.wait(len(chunk))
+            self.wfile.write(chunk)
+            remaining -= len(chunk)
+
+
+if __name__ == "__main__":
+    parser = ArgumentParser()
+    parser.add_argument("directory", help="directory with the files to serve")
+    parser.add_argument("-p", "--port", type=int, default=8080)
+    parser.add_argument(
+        "-r", "--rtt", type=float, default=0.0, help="round-trip time per request, in ms"
+    )
+    parser.add_argument(
+        "-b",
+        "--bandwidth",
+        type=float,
+        default=0.0,
+        help="total bandwidth, in MB/s (default: unlimited)",
+    )
+    args = parser.parse_args()
+
+    LatencyRequestHandler.rtt = args.rtt / 1e3
+    LatencyRequestHandler.throttle = Throttle(args.bandwidth * 1e6)
+
+    os.chdir(args.directory)
+    server = ThreadingHTTPServer(("localhost", args.port), LatencyRequestHandler)
+    server.daemon_threads = True
+
+    def shutdown(signum, frame):
+        LatencyRequestHandler.stats.print()
+        sys.exit(0)
+
+    signal.signal(signal.SIGTERM, shutdown)
+    signal.signal(signal.SIGINT, shutdown)
+
+    print(
+        f"Serving {args.directory} on http://localhost:{args.port} "
+        f"(RTT {args.rtt} ms, bandwidth {args.bandwidth or 'unlimited'} MB/s)",
+        file=sys.stderr,
+    )
+    server.serve_forever()
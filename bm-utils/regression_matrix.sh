@@ -0,0 +1,22 @@
+# Benchmark matrix of bm_regression.sh, which runs every combination of the values below. This file
+# is sourced by the runner, so a copy with different values can be passed to it, and each value can
+# also be overridden with an environment variable.
+
+# Storage formats and samples to read, i.e. INPUT_DIR/SAMPLE/DAOD_PHYS.FORMAT.root~COMPRESSION
+FORMATS=${FORMATS:-"ttree rntuple"}
+SAMPLES=${SAMPLES:-"data mc"}
+COMPRESSIONS=${COMPRESSIONS:-"0 505"}
+
+# Comma-separated thread counts, passed to a single bm_readspeed invocation. The number of cores is
+# only added on multi-core hosts, since a duplicate thread count would run its event loops twice.
+THREAD_COUNTS=${THREAD_COUNTS:-"1$([ $(nproc) -gt 1 ] && echo ,$(nproc))"}
+
+# Storage media as NAME=INPUT_DIR. The page cache is evicted before each event loop, except for
+# tmpfs, which is read with a warm-up run instead.
+MEDIA=${MEDIA:-"ssd=data"}
+
+# Workload files of bm_readspeed. The results are tagged with the file name without extension.
+WORKLOADS=${WORKLOADS:-"bm-readspeed/workloads/default.txt bm-readspeed/workloads/auxdyn_10pct.txt"}
+
+# Number of event loops per configuration. The significance test needs at least 5 per run.
+N_REPETITIONS=${N_REPETITIONS:-10}
@@ -0,0 +1,433 @@
+#include <ROOT/RNTupleFillContext.hxx>
+#include <ROOT/RNTupleModel.hxx>
+#include <ROOT/RNTupleOptions.hxx>
+#include <ROOT/RNTupleParallelWriter.hxx>
+#include <ROOT/RNTupleWriter.hxx>
+#include <ROOT/TBufferMerger.hxx>
+
+#include <TFile.h>
+#include <TROOT.h>
+#include <TTree.h>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bm-utils/bm_daod_phys.hxx"
+#include "bm-utils/bm_memory.hxx"
+#include "bm-utils/bm_options.hxx"
+#include "bm-utils/bm_output.hxx"
+#include "bm-utils/bm_tree.hxx"
+
+using ROOT::Experimental::RNTupleModel;
+using ROOT::Experimental::RNTupleParallelWriter;
+using ROOT::Experimental::RNTupleWriteOptions;
+using ROOT::Experimental::RNTupleWriter;
+
+// Number of distinct events that are generated up front and then written round-robin, so the
+// generation of the events is not part of the measurement.
+constexpr std::size_t kEventPoolSize = 1000;
+
+struct WritespeedConfig {
+  std::string outputDir = ".";
+  bool isRNTuple = false;
+  std::uint64_t nEvents = 180000;
+  std::vector<int> compressionSettings = {0, 201, 207, 404, 505};
+  unsigned nThreads = 1;
+  bool useBufferedWrite = true;
+  // Approximate compressed cluster size (RNTuple) or auto-flush size (TTree), in bytes.
+  std::size_t clusterSize = 0;
+  // Approximate uncompressed page size (RNTuple) or basket size (TTree), in bytes.
+  std::size_t pageSize = 0;
+  ExtraColumns extraColumns;
+  unsigned nRepetitions = 1;
+  bool keepOutput = false;
+  EOutputFormat outputFormat = EOutputFormat::kText;
+};
+
+struct WriteResult {
+  int compression;
+  unsigned repetition;
+  double wallTime; // in seconds
+  double cpuTime;  // in seconds
+  long maxRSS;     // in kB
+  std::uintmax_t fileBytes;
+  // Effective basket sizes of the TTree output
+  BasketSizeStats basketSizes;
+};
+
+std::string getOutputPath(const WritespeedConfig &config, int compression) {
+  return config.outputDir + "/writespeed." + (config.isRNTuple ? "rntuple" : "ttree") + ".root~" +
+         std::to_string(compression);
+}
+
+double getCPUTime() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 + usage.ru_stime.tv_sec +
+         usage.ru_stime.tv_usec / 1e6;
+}
+
+std::vector<DaodPhysEvent_t> generateEventPool(const WritespeedConfig &config) {
+  std::vector<DaodPhysEvent_t> pool;
+  std::mt19937_64 rng(42);
+  for (std::size_t i = 0; i < std::min<std::uint64_t>(kEventPoolSize, config.nEvents); ++i) {
+    auto event = createEvent(config.extraColumns);
+    generateEvent(event, rng);
+    pool.emplace_back(std::move(event));
+  }
+  return pool;
+}
+
+// Runs fillFn(threadId, firstEvent, lastEvent) on nThreads threads, each for an equal share of the
+// events.
+template <typename F> void runFillThreads(const WritespeedConfig &config, F &&fillFn) {
+  std::vector<std::thread> threads;
+  for (unsigned t = 0; t < config.nThreads; ++t) {
+    const std::uint64_t first = config.nEvents * t / config.nThreads;
+    const std::uint64_t last = config.nEvents * (t + 1) / config.nThreads;
+    threads.emplace_back(fillFn, t, first, last);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+void bmNTupleWritespeed(const WritespeedConfig &config, int compression,
+                        const std::vector<DaodPhysEvent_t> &pool) {
+  const auto outputPath = getOutputPath(config, compression);
+
+  RNTupleWriteOptions writeOptions;
+  writeOptions.SetCompression(compression);
+  writeOptions.SetUseBufferedWrite(config.useBufferedWrite);
+  if (config.clusterSize > 0)
+    writeOptions.SetApproxZippedClusterSize(config.clusterSize);
+  if (config.pageSize > 0)
+    writeOptions.SetApproxUnzippedPageSize(config.pageSize);
+
+  auto model = RNTupleModel::CreateBare();
+  auto modelEvent = createEvent(config.extraColumns);
+  addFields(*model, modelEvent);
+
+  if (config.nThreads == 1) {
+    auto writer =
+        RNTupleWriter::Recreate(std::move(model), "CollectionTree", outputPath, writeOptions);
+    auto event = createEvent(config.extraColumns);
+    auto entry = writer->CreateEntry();
+    bindEntry(*entry, event);
+
+    for (std::uint64_t i = 0; i < config.nEvents; ++i) {
+      copyEvent(pool[i % pool.size()], event);
+      writer->Fill(*entry);
+    }
+    return;
+  }
+
+  auto writer =
+      RNTupleParallelWriter::Recreate(std::move(model), "CollectionTree", outputPath, writeOptions);
+  runFillThreads(config, [&](unsigned, std::uint64_t first, std::uint64_t last) {
+    auto fillContext = writer->CreateFillContext();
+    auto event = createEvent(config.extraColumns);
+    auto entry = fillContext->CreateEntry();
+    bindEntry(*entry, event);
+
+    for (std::uint64_t i = first; i < last; ++i) {
+      copyEvent(pool[i % pool.size()], event);
+      fillContext->Fill(*entry);
+    }
+  });
+}
+
+void configureTree(const WritespeedConfig &config, TTree &tree) {
+  if (config.clusterSize > 0)
+    tree.SetAutoFlush(-static_cast<Long64_t>(config.clusterSize));
+  if (config.pageSize > 0)
+    tree.SetBasketSize("*", config.pageSize);
+}
+
+void bmTreeWritespeed(const WritespeedConfig &config, int compression,
+                      const std::vector<DaodPhysEvent_t> &pool) {
+  const auto outputPath = getOutputPath(config, compression);
+
+  if (config.nThreads == 1) {
+    auto file =
+        std::unique_ptr<TFile>(TFile::Open(outputPath.c_str(), "RECREATE", "", compression));
+    auto tree = new TTree("CollectionTree", "CollectionTree");
+    auto event = createEvent(config.extraColumns);
+    addBranches(*tree, event);
+    configureTree(config, *tree);
+
+    for (std::uint64_t i = 0; i < config.nEvents; ++i) {
+      copyEvent(pool[i % pool.size()], event);
+      tree->Fill();
+    }
+    file->Write();
+    return;
+  }
+
+  // Every thread fills its own tree in an in-memory file, which is merged into the output file
+  // each time the tree is flushed (like RDataFrame's multi-threaded Snapshot).
+  ROOT::TBufferMerger merger(outputPath.c_str(), "RECREATE", compression);
+  runFillThreads(config, [&](unsigned, std::uint64_t first, std::uint64_t last) {
+    auto file = merger.GetFile();
+    auto tree = new TTree("CollectionTree", "CollectionTree");
+    tree->SetDirectory(file.get());
+    auto event = createEvent(config.extraColumns);
+    addBranches(*tree, event);
+    configureTree(config, *tree);
+
+    for (std::uint64_t i = first; i < last; ++i) {
+      copyEvent(pool[i % pool.size()], event);
+      tree->Fill();
+      const auto autoFlush = tree->GetAutoFlush();
+      if (autoFlush > 0 && tree->GetEntries() % autoFlush == 0)
+        file->Write();
+    }
+    file->Write();
+  });
+}
+
+std::vector<WriteResult> runWritespeed(const WritespeedConfig &config) {
+  const auto pool = generateEventPool(config);
+
+  std::vector<WriteResult> results;
+  for (const auto compression : config.compressionSettings) {
+    for (unsigned r = 0; r < config.nRepetitions; ++r) {
+      resetPeakRSS();
+      const auto cpuStart = getCPUTime();
+      const auto start = std::chrono::steady_clock::now();
+
+      if (config.isRNTuple)
+        bmNTupleWritespeed(config, compression, pool);
+      else
+        bmTreeWritespeed(config, compression, pool);
+
+      WriteResult result{compression, r, 0., 0., 0, 0};
+      result.wallTime =
+          std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      result.cpuTime = getCPUTime() - cpuStart;
+      result.maxRSS = getPeakRSS();
+
+      const auto outputPath = getOutputPath(config, compression);
+      result.fileBytes = std::filesystem::file_size(outputPath);
+      if (!config.isRNTuple)
+        result.basketSizes = getBasketSizeStats(outputPath, "CollectionTree");
+      if (!config.keepOutput)
+        std::filesystem::remove(outputPath);
+
+      results.emplace_back(result);
+    }
+  }
+  return results;
+}
+
+std::vector<MetricsRecord_t> getRecords(const WritespeedConfig &config,
+                                        const std::vector<WriteResult> &results) {
+  std::vector<MetricsRecord_t> records;
+  for (const auto &r : results) {
+    MetricsRecord_t record;
+    addMetric(record, "format", config.isRNTuple ? "rntuple" : "ttree");
+    addMetric(record, "compression", r.compression);
+    addMetric(record, "threads", config.nThreads);
+    addMetric(record, "buffered", config.useBufferedWrite ? 1 : 0);
+    addMetric(record, "cluster_size", config.clusterSize);
+    addMetric(record, "page_size", config.pageSize);
+    addMetric(record, "repetition", r.repetition);
+    addMetric(record, "events", config.nEvents);
+    addMetric(record, "file_bytes", r.fileBytes);
+    addMetric(record, "wall_time_s", r.wallTime);
+    addMetric(record, "cpu_time_s", r.cpuTime);
+    addMetric(record, "events_per_s", config.nEvents / r.wallTime);
+    addMetric(record, "mb_per_s", r.fileBytes / 1e6 / r.wallTime);
+    addMetric(record, "peak_rss_kb", r.maxRSS);
+    if (!config.isRNTuple) {
+      addMetric(record, "basket_size_min", r.basketSizes.minBufferSize);
+      addMetric(record, "basket_size_max", r.basketSizes.maxBufferSize);
+      addMetric(record, "basket_size_mean", r.basketSizes.meanBufferSize);
+      addMetric(record, "basket_bytes_mean", r.basketSizes.meanBasketBytes);
+    }
+    records.emplace_back(std::move(record));
+  }
+  return records;
+}
+
+void printResults(const std::vector<MetricsRecord_t> &records) {
+  for (std::size_t i = 0; i < records[0].size(); ++i) {
+    std::cout << (i == 0 ? "" : "\t") << records[0][i].first;
+  }
+  std::cout << std::endl;
+
+  for (const auto &record : records) {
+    for (std::size_t i = 0; i < record.size(); ++i) {
+      std::cout << (i == 0 ? "" : "\t") << record[i].second.value;
+    }
+    std::cout << std::endl;
+  }
+}
+
+std::vector<int> parseCompressionSettings(const std::string &arg) {
+  std::vector<int> settings;
+  std::stringstream ss(arg);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    settings.emplace_back(std::atoi(item.c_str()));
+  }
+  return settings;
+}
+
+static void printUsage(std::string_view prog) {
+  std::cout << "USAGE: " << prog
+            << " (-h|-s (ttree|rntuple) [-d OUTPUT_DIR] [-e N_EVENTS] "
+               "[-c COMPRESSION[,COMPRESSION...]] [-t N_THREADS] [-u] [-C CLUSTER_SIZE] "
+               "[-P PAGE_SIZE] [-I N_INT_COLUMNS] [-A N_CHAR_COLUMNS] [-V N_NESTED_VECTOR_COLUMNS] "
+               "[-r N_REPETITIONS] [-k] [-o (text|json|csv)])"
+            << std::endl;
+}
+
+int main(int argc, char **argv) {
+  // Suppress (irrelevant) warnings
+  gErrorIgnoreLevel = kError;
+
+  WritespeedConfig config;
+  bool storeTypeSet = false;
+
+  int c;
+  while ((c = getopt(argc, argv, "hs:d:e:c:t:uC:P:I:A:V:r:ko:")) != -1) {
+    switch (c) {
+    case 'h':
+      printUsage(argv[0]);
+      return 0;
+    case 's':
+      if (strcmp(optarg, "ttree") == 0) {
+        config.isRNTuple = false;
+      } else if (strcmp(optarg, "rntuple") == 0) {
+        config.isRNTuple = true;
+      } else {
+        std::cerr << "ERROR: Unknown storage mode " << optarg << std::endl;
+        return 1;
+      }
+      storeTypeSet = true;
+      break;
+    case 'd':
+      config.outputDir = optarg;
+      break;
+    case 'e':
+      if (!parseUnsigned(optarg, config.nEvents)) {
+        std::cerr << "ERROR: invalid number of events " << optarg << std::endl;
+        return 1;
+      }
+      break;
+    case 'c':
+      config.compressionSettings = parseCompressionSettings(optarg);
+      break;
+    case 't':
+      if (!parseUnsigned(optarg, config.nThreads)) {
+        std::cerr << "ERROR: invalid number of threads " << optarg << std::endl;
+        return 1;
+      }
+      if (config.nThreads == 0) {
+        std::cerr << "ERROR: the number of threads must be at least 1" << std::endl;
+        return 1;
+      }
+      break;
+    case 'u':
+      config.useBufferedWrite = false;
+      break;
+    case 'C':
+      if (!parseUnsigned(optarg, config.clusterSize)) {
+        std::cerr << "ERROR: invalid cluster size " << optarg << std::endl;
+        return 1;
+      }
+      break;
+    case 'P':
+      if (!parseUnsigned(optarg, config.pageSize)) {
+        std::cerr << "ERROR: invalid page size " << optarg << std::endl;
+        return 1;
+      }
+      break;
+    case 'I':
+      if (!parseUnsigned(optarg, config.extraColumns.nIntColumns)) {
+        std::cerr << "ERROR: invalid number of int columns " << optarg << std::endl;
+        return 1;
+      }
+      break;
+    case 'A':
+      if (!parseUnsigned(optarg, config.extraColumns.nCharColumns)) {
+        std::cerr << "ERROR: invalid number of char columns " << optarg << std::endl;
+        return 1;
+      }
+      break;
+    case 'V':
+      if (!parseUnsigned(optarg, config.extraColumns.nNestedColumns)) {
+        std::cerr << "ERROR: invalid number of nested vector columns " << optarg << std::endl;
+        return 1;
+      }
+      break;
+    case 'r':
+      if (!parseUnsigned(optarg, config.nRepetitions)) {
+        std::cerr << "ERROR: invalid number of repetitions " << optarg << std::endl;
+        return 1;
+      }
+      if (config.nRepetitions == 0) {
+        std::cerr << "ERROR: the number of repetitions must be at least 1" << std::endl;
+        return 1;
+      }
+      break;
+    case 'k':
+      config.keepOutput = true;
+      break;
+    case 'o':
+      if (!parseOutputFormat(optarg, config.outputFormat)) {
+        std::cerr << "ERROR: Unknown output format " << optarg << std::endl;
+        return 1;
+      }
+      break;
+    default:
+      printUsage(argv[0]);
+      return 1;
+    }
+  }
+
+  if (!storeTypeSet) {
+    std::cerr << "ERROR: please specify the storage type (ttree or rntuple)\n" << std::endl;
+    printUsage(argv[0]);
+    return 1;
+  }
+
+  if (config.nEvents == 0) {
+    std::cerr << "ERROR: the number of events must be at least 1" << std::endl;
+    return 1;
+  }
+
+  if (!config.useBufferedWrite && !config.isRNTuple) {
+    std::cerr << "ERROR: unbuffered writing is only available for RNTuple" << std::endl;
+    return 1;
+  }
+
+  if (!config.useBufferedWrite && config.nThreads > 1) {
+    std::cerr << "ERROR: parallel RNTuple writing requires buffered writing" << std::endl;
+    return 1;
+  }
+
+  if (config.nThreads > 1)
+    ROOT::EnableThreadSafety();
+
+  std::filesystem::create_directories(config.outputDir);
+
+  const auto records = getRecords(config, runWritespeed(config));
+  if (config.outputFormat == EOutputFormat::kText)
+    printResults(records);
+  else
+    writeRecords(std::cout, records, config.outputFormat);
+
+  return 0;
+}
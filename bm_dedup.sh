@@ -0,0 +1,94 @@
+#!/usr/bin/env bash
+
+# Compares the two variants written by bm_dedup_index: every AuxDyn vector field with its own offset
+# column (baseline) and one shared offset column per container (shared). Both files are measured
+# with bm_size and bm_readspeed, and the shared variant is compared against the baseline variant
+# with compare_results.py.
+
+# A crashing benchmark must not leave a (partial) CSV that passes as a result.
+set -o pipefail
+
+COMPRESSION=${COMPRESSION:-505}
+CONTAINER_REGEX=${CONTAINER_REGEX:-".*"}
+WORKLOAD=${WORKLOAD:-bm-readspeed/workloads/auxdyn_100pct.txt}
+ACCESS=${ACCESS:-rdf}
+THREAD_COUNTS=${THREAD_COUNTS:-1}
+
+# Prefixes every line of a CSV result with the sample and workload, like bm_regression.sh, so the
+# results can be compared with compare_results.py.
+function tag_csv() {
+  awk -v s=$1 -v w=$2 'NR == 1 { print "sample,workload," $0; next } { print s "," w "," $0 }'
+}
+
+# Runs a benchmark with its CSV output tagged and written to the given file, and its stderr appended
+# to the log. Failures are recorded, so the script fails after all benchmarks have run.
+function run_tagged() {
+  local results_file=$1
+  local workload=$2
+  shift 2
+
+  echo "$ $*" >> $LOG_FILE
+  if ! "$@" 2>> $LOG_FILE | tag_csv dedup $workload > $results_file; then
+    echo "ERROR: $1 failed, see $LOG_FILE"
+    echo "$*" >> ${RESULTS_DIR}/failed.txt
+    FAILED=true
+  fi
+}
+
+function main() {
+  mkdir -p $WORK_DIR ${RESULTS_DIR}/baseline ${RESULTS_DIR}/shared
+
+  echo "Writing the baseline and shared variants of $INPUT_FILE..."
+  echo "$ bin/bm_dedup_index -i $INPUT_FILE -d $WORK_DIR -x $CONTAINER_REGEX -c $COMPRESSION" \
+    >> $LOG_FILE
+  if ! bin/bm_dedup_index -i $INPUT_FILE -d $WORK_DIR -x "$CONTAINER_REGEX" -c $COMPRESSION \
+    2>> $LOG_FILE | tee ${RESULTS_DIR}/plans.txt; then
+    echo "ERROR: bm_dedup_index failed, see $LOG_FILE"
+    exit 1
+  fi
+
+  workload=$(basename $WORKLOAD .txt)
+  for variant in {baseline,shared}; do
+    input_file=${WORK_DIR}/DAOD_PHYS.rntuple_${variant}.root~${COMPRESSION}
+
+    echo "Running for the $variant variant..."
+    run_tagged ${RESULTS_DIR}/${variant}/size_dedup.csv - \
+      bin/bm_size -i $input_file -s rntuple -o csv
+    run_tagged ${RESULTS_DIR}/${variant}/readspeed_dedup_${workload}.csv $workload \
+      bin/bm_readspeed -i $input_file -s rntuple -w $WORKLOAD -a $ACCESS -t $THREAD_COUNTS \
+      -r $N_REPETITIONS -c -o csv
+  done
+
+  if [ "$FAILED" = true ]; then
+    echo "ERROR: some benchmarks failed, see ${RESULTS_DIR}/failed.txt"
+    exit 1
+  fi
+
+  # The shared variant is compared as the run against the baseline variant, so "REGRESSION" means
+  # that sharing the offset columns made the file larger or the event loop slower. This is the
+  # result of the comparison rather than a failure, so its exit status is not propagated.
+  python bm-utils/compare_results.py ${RESULTS_DIR}/baseline ${RESULTS_DIR}/shared \
+    | tee ${RESULTS_DIR}/comparison.txt
+}
+
+if [ -z "$1" ]; then
+  echo "USAGE: $0 INPUT_FILE [WORK_DIR] [N_REPETITIONS] [RESULTS_DIR]"
+  exit 1
+fi
+
+# The RNTuple file (e.g. imported with bm_convert) whose AuxDyn vector fields are rewritten
+INPUT_FILE=$1
+
+# Directory for the two variants, i.e. the storage medium under test
+WORK_DIR=${2:-data/dedup}
+
+# Get the number of repetitions from the command line or use the default value (10). The
+# significance test of compare_results.py needs at least 5.
+N_REPETITIONS=${3:-10}
+
+RESULTS_DIR=${4:-results/dedup}
+
+LOG_FILE=${RESULTS_DIR}/bm_dedup.log
+FAILED=false
+
+main
@@ -0,0 +1,41 @@
+#!/usr/bin/env bash
+
+function bm_kernels() {
+  storage_type=$1
+  results_dir=$2
+
+  mkdir -p $results_dir
+
+  for phys_file_type in {data,mc}; do
+    for compression in {0,201,207,404,505}; do
+      source_file=${SOURCE_DIR}/${phys_file_type}/DAOD_PHYS.${storage_type}.root~${compression}
+      results_file=${results_dir}/kernels_${storage_type}_${phys_file_type}_${compression}.csv
+
+      echo "Running for $storage_type ($phys_file_type, $compression)..."
+
+      if ! bin/bm_kernels -i $source_file -s $storage_type -t 1,$N_THREADS -r $N_REPETITIONS \
+        -o csv > $results_file; then
+        echo "ERROR: bm_kernels failed for $source_file"
+        STATUS=1
+      fi
+    done
+  done
+}
+
+function main() {
+  bm_kernels ttree $1
+  bm_kernels rntuple $1
+  exit $STATUS
+}
+
+STATUS=0
+
+SOURCE_DIR=${1:-data/}
+
+# Get the number of repetitions from the command line or use the default value (5)
+N_REPETITIONS=${2:-5}
+
+# Number of threads for the multi-threaded runs (default is the number of cores)
+N_THREADS=${4:-$(nproc)}
+
+main ${3:-results/kernels}
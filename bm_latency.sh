@@ -0,0 +1,58 @@
+#!/usr/bin/env bash
+
+# Round-trip times (in ms) to emulate and the total bandwidth (in MB/s, 0 is unlimited)
+RTTS=${RTTS:-"0 1 5 10 50 100"}
+BANDWIDTH=${BANDWIDTH:-0}
+COMPRESSION=${COMPRESSION:-505}
+PORT=${PORT:-8080}
+
+function start_server() {
+  rtt=$1
+  python bm-utils/latency_server.py $SOURCE_DIR -p $PORT -r $rtt -b $BANDWIDTH \
+    2>> ${RESULTS_DIR}/server_${rtt}ms.log &
+  SERVER_PID=$!
+
+  # Wait until the server accepts connections
+  for i in {1..50}; do
+    curl -s -o /dev/null http://localhost:${PORT}/ && return
+    sleep 0.1
+  done
+}
+
+function stop_server() {
+  kill $SERVER_PID
+  wait $SERVER_PID 2> /dev/null
+}
+
+function bm_latency() {
+  storage_type=$1
+
+  for phys_file_type in {data,mc}; do
+    for rtt in $RTTS; do
+      source_url=http://localhost:${PORT}/${phys_file_type}/DAOD_PHYS.${storage_type}.root~${COMPRESSION}
+      results_file=${RESULTS_DIR}/readspeed_${storage_type}_${phys_file_type}_${rtt}ms.csv
+
+      echo "Running for $storage_type ($phys_file_type, RTT $rtt ms)..."
+
+      start_server $rtt
+      bin/bm_readspeed -i $source_url -s $storage_type -r $N_REPETITIONS -m http_${rtt}ms -o csv \
+        > $results_file
+      stop_server
+    done
+  done
+}
+
+function main() {
+  mkdir -p $RESULTS_DIR
+  bm_latency ttree
+  bm_latency rntuple
+}
+
+SOURCE_DIR=${1:-data/}
+
+# Get the number of repetitions from the command line or use the default value (10)
+N_REPETITIONS=${2:-10}
+
+RESULTS_DIR=${3:-results/latency}
+
+main
@@ -2,10 +2,6 @@
 
 COLD_CACHE=true
 
-function drop_caches() {
-  sudo sh -c 'echo 3 > /proc/sys/vm/drop_caches'
-}
-
 function bm_readspeed() {
   storage_type=$1
   results_dir=$2/$storage_type
@@ -27,18 +23,14 @@ function bm_readspeed() {
 
       echo "Running for $storage_type ($phys_file_type, $compression)..."
 
-      for (( i = 0; i < $N_REPETITIONS; i++ )); do
-        if [ "$COLD_CACHE" = true ]; then
-          drop_caches
-        fi
-
-        if [ "$COLD_CACHE" = false ] && [ "$i" = 0 ]; then
-          continue
-        fi
+      if [ "$COLD_CACHE" = true ]; then
+        bm_flags="-c"
+      else
+        bm_flags="-W 1"
+      fi
 
-        results=$(bin/bm_readspeed -i $source_file -s $storage_type 2>&1)
-        echo "$results" >> $results_file
-      done
+      results=$(bin/bm_readspeed -i $source_file -s $storage_type -r $N_REPETITIONS $bm_flags 2>&1)
+      echo "$results" >> $results_file
     done
   done
 }
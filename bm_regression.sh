@@ -0,0 +1,131 @@
+#!/usr/bin/env bash
+
+# A crashing benchmark must not leave a (partial) CSV that passes as a result.
+set -o pipefail
+
+# Prefixes every line of a CSV result with the sample and workload, which bm_readspeed and bm_size
+# do not know about themselves.
+function tag_csv() {
+  awk -v s=$1 -v w=$2 'NR == 1 { print "sample,workload," $0; next } { print s "," w "," $0 }'
+}
+
+function write_run_info() {
+  {
+    echo "key,value"
+    echo "run_id,$RUN_ID"
+    echo "date,$(date -u +%Y-%m-%dT%H:%M:%SZ)"
+    echo "root_version,$(root-config --version)"
+    echo "root_has_uring,$(root-config --has-uring)"
+    echo "atlas_bm_commit,$(git rev-parse --short HEAD 2> /dev/null)"
+    echo "host,$(hostname)"
+    echo "kernel,$(uname -r)"
+    echo "cpu,\"$(grep -m 1 'model name' /proc/cpuinfo | cut -d ':' -f 2 | xargs)\""
+    echo "cores,$(nproc)"
+    echo "memory_kb,$(grep MemTotal /proc/meminfo | awk '{ print $2 }')"
+    echo "matrix,$MATRIX_FILE"
+  } > ${RUN_DIR}/run_info.csv
+}
+
+# Runs a benchmark with its CSV output tagged and written to the given file, and its stderr appended
+# to the log of the run. Failures are recorded, so the run fails even if the comparison passes.
+function run_tagged() {
+  results_file=$1
+  sample=$2
+  workload=$3
+  shift 3
+
+  echo "$ $*" >> $LOG_FILE
+  if ! "$@" 2>> $LOG_FILE | tag_csv $sample $workload > $results_file; then
+    echo "ERROR: $1 failed, see $LOG_FILE"
+    echo "$*" >> ${RUN_DIR}/failed.txt
+    FAILED=true
+  fi
+}
+
+function bm_regression() {
+  for medium_spec in $MEDIA; do
+    medium=${medium_spec%%=*}
+    input_dir=${medium_spec#*=}
+
+    if [ "$medium" = "tmpfs" ]; then
+      cache_flags="-W 1"
+    else
+      cache_flags="-c"
+    fi
+
+    for storage_type in $FORMATS; do
+      for phys_file_type in $SAMPLES; do
+        for compression in $COMPRESSIONS; do
+          source_file=${input_dir}/${phys_file_type}/DAOD_PHYS.${storage_type}.root~${compression}
+          config_name=${storage_type}_${phys_file_type}_${compression}
+
+          # The size does not depend on the medium, but the memory needed to open the file can, so
+          # it is measured on each medium, with the same tags as the bm_readspeed records.
+          run_tagged ${RUN_DIR}/size_${config_name}_${medium}.csv $phys_file_type - \
+            bin/bm_size -i $source_file -s $storage_type -m $medium -o csv
+
+          for workload_file in $WORKLOADS; do
+            workload=$(basename $workload_file .txt)
+
+            echo "Running for $storage_type ($phys_file_type, $compression, $medium, $workload)..."
+
+            run_tagged ${RUN_DIR}/readspeed_${config_name}_${medium}_${workload}.csv \
+              $phys_file_type $workload \
+              bin/bm_readspeed -i $source_file -s $storage_type -w $workload_file \
+              -t $THREAD_COUNTS -r $N_REPETITIONS $cache_flags -m $medium -o csv
+          done
+        done
+      done
+    done
+  done
+}
+
+function main() {
+  mkdir -p $RUN_DIR
+  write_run_info
+  bm_regression
+
+  # The first run becomes the baseline, unless one of its benchmarks failed.
+  if [ ! -e $BASELINE_DIR ]; then
+    if [ "$FAILED" = true ]; then
+      echo "ERROR: not using $RUN_DIR as the baseline, since some benchmarks failed"
+      exit 1
+    fi
+    echo "No baseline found, using $RUN_DIR as the baseline"
+    ln -s $(realpath $RUN_DIR) $BASELINE_DIR
+    exit 0
+  fi
+
+  python bm-utils/compare_results.py $BASELINE_DIR $RUN_DIR | tee ${RUN_DIR}/comparison.txt
+  status=${PIPESTATUS[0]}
+
+  if [ "$FAILED" = true ]; then
+    echo "ERROR: some benchmarks failed, see ${RUN_DIR}/failed.txt"
+    exit 1
+  fi
+
+  if [ "$UPDATE_BASELINE" = true ]; then
+    ln -sfn $(realpath $RUN_DIR) $BASELINE_DIR
+  fi
+
+  exit $status
+}
+
+# File declaring the benchmark matrix (see bm-utils/regression_matrix.sh for the defaults)
+MATRIX_FILE=${1:-bm-utils/regression_matrix.sh}
+source $MATRIX_FILE
+
+# Each run is stored in its own directory, next to a link to the baseline run
+RESULTS_DIR=${2:-results/regression}
+RUN_ID=${RUN_ID:-$(date +%Y%m%d_%H%M%S)_root$(root-config --version | tr '/' '.')}
+RUN_DIR=${RESULTS_DIR}/${RUN_ID}
+BASELINE_DIR=${BASELINE_DIR:-${RESULTS_DIR}/baseline}
+
+# Make this run the new baseline after comparing it against the current one (runs with failed
+# benchmarks never become the baseline)
+UPDATE_BASELINE=${UPDATE_BASELINE:-false}
+
+LOG_FILE=${RUN_DIR}/bm_regression.log
+FAILED=false
+
+main
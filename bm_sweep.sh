@@ -0,0 +1,123 @@
+#!/usr/bin/env bash
+
+# Approximate compressed cluster sizes and uncompressed page sizes (in bytes) to sweep over. For
+# TTree, these are used as the auto-flush size and the initial basket size, respectively. TTree
+# re-optimizes the basket sizes at the first auto-flush, so the effective basket sizes are reported
+# in the conversion results (basket_size_* and basket_bytes_mean).
+CLUSTER_SIZES=${CLUSTER_SIZES:-"10000000 25000000 50000000 100000000 200000000"}
+PAGE_SIZES=${PAGE_SIZES:-"16384 65536 262144 1048576"}
+COMPRESSION=${COMPRESSION:-505}
+# The number of cores is only added on multi-core hosts, so 1 is not measured twice.
+THREAD_COUNTS=${THREAD_COUNTS:-"1$([ $(nproc) -gt 1 ] && echo ,$(nproc))"}
+KEEP_INPUTS=${KEEP_INPUTS:-false}
+
+# A failing benchmark must not leave a (partial) CSV that passes as a result.
+set -o pipefail
+
+# Prefixes every line of a CSV result with the sweep point, so the results of all points can be
+# concatenated.
+function tag_csv() {
+  awk -v c=$1 -v p=$2 'NR == 1 { print "cluster_size,page_size," $0; next } { print c "," p "," $0 }'
+}
+
+# Runs a benchmark with its CSV output tagged with the sweep point and written to the given file,
+# and its stderr appended to the log of the sweep. Failures are recorded, so the sweep fails at the
+# end.
+function run_tagged() {
+  results_file=$1
+  cluster_size=$2
+  page_size=$3
+  shift 3
+
+  echo "$ $*" >> $LOG_FILE
+  if ! "$@" 2>> $LOG_FILE | tag_csv $cluster_size $page_size > $results_file; then
+    echo "ERROR: $1 failed, see $LOG_FILE"
+    echo "$*" >> ${RESULTS_DIR}/failed.txt
+    FAILED=true
+    return 1
+  fi
+}
+
+function bm_sweep_point() {
+  cluster_size=$1
+  page_size=$2
+  point_dir=${WORK_DIR}/c${cluster_size}_p${page_size}
+  point_name=c${cluster_size}_p${page_size}
+
+  echo "Converting for cluster size $cluster_size and page size $page_size..."
+  # Without the converted files, there is nothing to measure for this point.
+  if ! run_tagged ${RESULTS_DIR}/convert_${point_name}.csv $cluster_size $page_size \
+    bin/bm_convert -i $SOURCE_FILE -d $point_dir -c $COMPRESSION -C $cluster_size -P $page_size \
+    -o csv; then
+    rm -f ${RESULTS_DIR}/convert_${point_name}.csv
+    rm -rf $point_dir
+    return
+  fi
+
+  for storage_type in {ttree,rntuple}; do
+    input_file=${point_dir}/DAOD_PHYS.${storage_type}.root~${COMPRESSION}
+
+    echo "Running for $storage_type (cluster size $cluster_size, page size $page_size)..."
+
+    run_tagged ${RESULTS_DIR}/size_${storage_type}_${point_name}.csv $cluster_size $page_size \
+      bin/bm_size -i $input_file -s $storage_type -o csv \
+      || rm -f ${RESULTS_DIR}/size_${storage_type}_${point_name}.csv
+    run_tagged ${RESULTS_DIR}/readspeed_${storage_type}_${point_name}.csv $cluster_size \
+      $page_size bin/bm_readspeed -i $input_file -s $storage_type -t $THREAD_COUNTS \
+      -r $N_REPETITIONS -c -o csv \
+      || rm -f ${RESULTS_DIR}/readspeed_${storage_type}_${point_name}.csv
+  done
+
+  if [ "$KEEP_INPUTS" != true ]; then
+    rm -r $point_dir
+  fi
+}
+
+# Concatenates the per-point results into a single file per benchmark and format. The results of
+# failed benchmarks have been removed, so they are missing from the combined files.
+function combine_results() {
+  for bm in {size_ttree,size_rntuple,readspeed_ttree,readspeed_rntuple,convert}; do
+    results_files=$(ls ${RESULTS_DIR}/${bm}_c*_p*.csv 2> /dev/null)
+    if [ -n "$results_files" ]; then
+      awk 'FNR == 1 && NR != 1 { next } { print }' $results_files > ${RESULTS_DIR}/sweep_${bm}.csv
+    fi
+  done
+}
+
+function main() {
+  mkdir -p $RESULTS_DIR
+
+  for cluster_size in $CLUSTER_SIZES; do
+    for page_size in $PAGE_SIZES; do
+      bm_sweep_point $cluster_size $page_size
+    done
+  done
+
+  combine_results
+
+  if [ "$FAILED" = true ]; then
+    echo "ERROR: some benchmarks failed, see ${RESULTS_DIR}/failed.txt"
+    exit 1
+  fi
+}
+
+if [ -z "$1" ]; then
+  echo "USAGE: $0 SOURCE_FILE [WORK_DIR] [N_REPETITIONS] [RESULTS_DIR]"
+  exit 1
+fi
+
+# The (TTree) file the inputs of each sweep point are converted from
+SOURCE_FILE=$1
+
+# Directory for the converted inputs, i.e. the storage medium under test
+WORK_DIR=${2:-data/sweep}
+
+# Get the number of repetitions from the command line or use the default value (10)
+N_REPETITIONS=${3:-10}
+
+RESULTS_DIR=${4:-results/sweep}
+
+LOG_FILE=${RESULTS_DIR}/bm_sweep.log
+FAILED=false
+
+main
@@ -0,0 +1,44 @@
+#!/usr/bin/env bash
+
+function bm_writespeed() {
+  storage_type=$1
+  results_dir=$2
+
+  mkdir -p $results_dir
+
+  for n_threads in 1 $N_THREADS; do
+    results_file=${results_dir}/writespeed_${storage_type}_${n_threads}.csv
+
+    echo "Running for $storage_type ($n_threads threads)..."
+
+    results=$(bin/bm_writespeed -s $storage_type -d $OUTPUT_DIR -t $n_threads -r $N_REPETITIONS -o csv)
+    echo "$results"
+    echo "$results" > $results_file
+  done
+
+  if [ "$storage_type" = "rntuple" ]; then
+    results_file=${results_dir}/writespeed_${storage_type}_1_unbuffered.csv
+
+    echo "Running for $storage_type (unbuffered)..."
+
+    results=$(bin/bm_writespeed -s $storage_type -d $OUTPUT_DIR -u -r $N_REPETITIONS -o csv)
+    echo "$results"
+    echo "$results" > $results_file
+  fi
+}
+
+function main() {
+  bm_writespeed ttree $1
+  bm_writespeed rntuple $1
+}
+
+# Directory to write the (temporary) output files to, i.e. the storage medium under test
+OUTPUT_DIR=${1:-data/}
+
+# Get the number of repetitions from the command line or use the default value (10)
+N_REPETITIONS=${2:-10}
+
+# Number of fill threads for the multi-threaded runs (default is the number of cores)
+N_THREADS=${4:-$(nproc)}
+
+main ${3:-results/}